@@ -231,6 +231,30 @@ class ModelGenerator(Resource):
             ret["opcode"] = "success"
         return make_response(jsonify(ret))
 
+# A PUT body is a JSON string holding either one instance ("value") or a
+# batch of instances ("values"); returns the instances (None with the
+# failure in ret) and whether it was a batch
+def parse_instances(model_id, ret):
+    args = json.loads(request.get_json(force=True))
+    batch = "value" not in args
+    if not batch:
+        values = [args["value"]]
+    elif "values" in args:
+        values = args["values"]
+    else:
+        ret["opcode"] = "failure"
+        ret["reason"] = "the necessary attribute 'value' (or 'values') is not included"
+        return None, batch
+    logging.debug("values: {}".format(values))
+
+    dimension = ai.get_model_dimension(model_id)
+    for value in values:
+        if len(value) != dimension:
+            ret["opcode"] = "failure"
+            ret["reason"] = "not enough features. the dimension of the instance should be {} (the dimension of {} is given).".format(dimension, len(value))
+            return None, batch
+    return values, batch
+
 # URI: /<string: model_id>/training
 # HTTP behavior: GET, POST, PUT
 # GET: Get the information about the training data
@@ -257,19 +281,10 @@ class Trainer(Resource):
     def put(self, model_id):
         ret = {}
         if ai.has_model(model_id):
-            args = json.loads(request.get_json(force=True))
-            if "value" not in args:
-                ret["opcode"] = "failure"
-                ret["reason"] = "the necessary attribute 'value' is not included"
-            else:
-                value = args["value"]
-                logging.debug("value: {}".format(value))
-
-                if len(value) != ai.get_model_dimension(model_id):
-                    ret["opcode"] = "failure"
-                    ret["reason"] = "not enough features. the dimension of the instance should be {} (the dimension of {} is given).".format(ai.get_model_dimension(model_id), len(value))
-                else:
-                    ret["opcode"] = "success"
+            values, _ = parse_instances(model_id, ret)
+            if values is not None:
+                ret["opcode"] = "success"
+                for value in values:
                     ai.add_training_data(model_id, value)
         else:
             ret["opcode"] = "failure"
@@ -292,23 +307,19 @@ class Tester(Resource):
     def put(self, model_id):
         ret = {}
         if ai.has_model(model_id):
-            args = json.loads(request.get_json(force=True))
-            if "value" not in args:
-                ret["opcode"] = "failure"
-                ret["reason"] = "the necessary attribute 'value' is not included"
-            else:
-                value = args["value"]
-                logging.debug("value: {}".format(value))
-
-                if len(value) != ai.get_model_dimension(model_id):
-                    ret["opcode"] = "failure"
-                    ret["reason"] = "not enough features. the dimension of the instance should be {} (the dimension of {} is given).".format(ai.get_model_dimension(model_id, len(value)))
-                else:
+            values, batch = parse_instances(model_id, ret)
+            if values is not None:
+                predictions = []
+                for value in values:
                     ai.add_testing_data(model_id, value)
                     result = ai.prediction(model_id, value)
                     logging.debug("result: {}".format(result))
-                    ret["opcode"] = "success"
-                    ret["prediction"] = str(result)
+                    predictions.append(str(result))
+                ret["opcode"] = "success"
+                if batch:
+                    ret["predictions"] = predictions
+                else:
+                    ret["prediction"] = predictions[0]
         else:
             ret["opcode"] = "failure"
             ret["reason"] = "the model {} is unavailable".format(model_id)
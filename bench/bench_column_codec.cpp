@@ -0,0 +1,115 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include "../edge/byte_op.h"
+#include "../edge/column_codec.h"
+#include "../edge/setting.h"
+
+using namespace std;
+
+// The byte-by-byte form of VAR_TO_MEM_4BYTES_BIG_ENDIAN before it
+// forwarded to byte_codec.h, as the baseline
+#define LEGACY_VAR_TO_MEM_4BYTES_BIG_ENDIAN(v, p) \
+  *(p++) = (v >> 24) & 0xff; \
+  *(p++) = (v >> 16) & 0xff; \
+  *(p++) = (v >> 8) & 0xff; \
+  *(p++) = v & 0xff;
+
+static double now()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Best of 'rounds' runs of 'fn' over the column, in ns per float
+template <class F>
+static double measure(F fn, size_t n, int rounds)
+{
+  double best, start, t;
+
+  best = 1e30;
+  for (int r=0; r<rounds; r++)
+  {
+    start = now();
+    fn();
+    t = now() - start;
+    if (t < best)
+      best = t;
+  }
+  return best * 1e9 / n;
+}
+
+static void report(const char *name, double ns, double baseline, size_t n, int ok)
+{
+  printf("  %-26s %8.3f ns/float  %7.2f GB/s  x%-6.1f %s\n", name, ns,
+      4 / ns, baseline / ns, ok ? "" : "MISMATCH");
+  (void)n;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t n;
+  int rounds;
+  double base, ns;
+  uint32_t u;
+  enum column_codec best;
+
+  n = argc > 1 ? strtoul(argv[1], NULL, 0) : 24 * NUM_OF_CUSTOMER;
+  rounds = argc > 2 ? atoi(argv[2]) : 50;
+
+  vector<float> column(n);
+  vector<uint8_t> expected(4 * n), out(4 * n);
+  for (size_t i=0; i<n; i++)
+    column[i] = (float)rand() / RAND_MAX * 3.5f;
+
+  printf("[*] Encoding %zu floats to big-endian, best of %d runs\n", n, rounds);
+
+  base = measure([&]() {
+    uint8_t *p = expected.data();
+    for (size_t i=0; i<n; i++)
+    {
+      memcpy(&u, &column[i], 4);
+      LEGACY_VAR_TO_MEM_4BYTES_BIG_ENDIAN(u, p);
+    }
+  }, n, rounds);
+  report("legacy macro loop", base, base, n, 1);
+
+  ns = measure([&]() {
+    uint8_t *p = out.data();
+    for (size_t i=0; i<n; i++)
+    {
+      memcpy(&u, &column[i], 4);
+      VAR_TO_MEM_4BYTES_BIG_ENDIAN(u, p);
+    }
+  }, n, rounds);
+  report("VAR_TO_MEM (byte_codec)", ns, base, n, out == expected);
+
+  memset(out.data(), 0, out.size());
+  ns = measure([&]() { put_be_f32_array(out.data(), column.data(), n); }, n, rounds);
+  report("put_be_f32_array", ns, base, n, out == expected);
+
+  best = column_codec_current();
+  for (int c=0; c<NUM_OF_COLUMN_CODECS; c++)
+  {
+    char name[64];
+
+    if (column_codec_select((enum column_codec)c) == FAILURE)
+    {
+      printf("  %-26s not supported by this CPU\n", column_codec_name((enum column_codec)c));
+      continue;
+    }
+    memset(out.data(), 0, out.size());
+    ns = measure([&]() { encode_be_f32_column(out.data(), column.data(), n); }, n, rounds);
+    snprintf(name, sizeof(name), "encode_be_f32_column/%s", column_codec_name((enum column_codec)c));
+    report(name, ns, base, n, out == expected);
+  }
+  column_codec_select(best);
+  printf("[*] Runtime dispatch picks %s\n", column_codec_name(best));
+
+  return 0;
+}
@@ -0,0 +1,480 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+#include <getopt.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "../edge/edge.h"
+#include "../edge/data_receiver.h"
+#include "../edge/process_manager.h"
+#include "../edge/network_manager.h"
+#include "../edge/vector_layout.h"
+#include "../edge/logger.h"
+#include "../edge/metrics.h"
+#include "../edge/opcode.h"
+#include "../edge/byte_codec.h"
+#include "../edge/setting.h"
+#include "../edge/tools/alloc_track.h"
+
+using namespace std;
+
+// Benchmarks of the edge data path, one stage at a time and end to end.
+// Every thread runs its own pipeline; the results are printed as JSON
+
+#define START_TIME 1609459200
+#define DAY 86400
+#define POOL 32
+
+struct config
+{
+  int customers;
+  int vector_id;
+  int threads;
+  int ops;
+  int batch;
+  bool hourly;
+  uint64_t seed;
+  int history_days;
+};
+
+struct result
+{
+  const char *stage;
+  int customers;
+  long ops;              // over all threads
+  double seconds;        // wall time
+  struct alloc_stats alloc;
+  struct histogram_summary latency[NUM_OF_TIMERS];   // edge probes hit by the stage
+};
+
+static double now()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Runs body(thread index) on every thread and returns the wall time; the
+// allocation counts of all threads are summed into 'alloc'
+template <class F>
+static double parallel(int threads, struct alloc_stats *alloc, F body)
+{
+  vector<thread> workers;
+  vector<struct alloc_stats> stats(threads, alloc_stats{});
+  double start, end;
+
+  start = now();
+  for (int t=0; t<threads; t++)
+    workers.emplace_back([&, t]() {
+      AllocScope scope(&stats[t]);
+      body(t);
+    });
+  for (auto &w : workers)
+    w.join();
+  end = now();
+
+  *alloc = {};
+  for (auto &s : stats)
+  {
+    alloc->count += s.count;
+    alloc->bytes += s.bytes;
+    alloc->frees += s.frees;
+  }
+  return end - start;
+}
+
+// ====== Loopback sink ======
+// Accepts 'conns' connections and reads frames; with 'reply' it answers
+// every frame with OPCODE_DONE until 'records' vectors arrived on that
+// connection, then with OPCODE_QUIT
+class Sink
+{
+  private:
+    int sock;
+    int port;
+    vector<thread> readers;
+
+    static bool readAll(int fd, uint8_t *buf, size_t len)
+    {
+      size_t off = 0;
+      ssize_t n;
+
+      while (off < len)
+      {
+        n = read(fd, buf + off, len - off);
+        if (n <= 0)
+          return false;
+        off += n;
+      }
+      return true;
+    }
+
+    static void serve(int fd, bool reply, long records)
+    {
+      uint8_t hdr[4], op;
+      vector<uint8_t> payload;
+      long received = 0;
+      int count, dim;
+
+      while (readAll(fd, hdr, 2))
+      {
+        count = 1;
+        if (hdr[0] == OPCODE_BATCH)
+        {
+          if (!readAll(fd, hdr + 2, 2))
+            break;
+          count = get_be16(hdr + 2);
+        }
+        dim = hdr[1] < NUM_OF_VECTORS ? vector_table[hdr[1]].dim : 0;
+        payload.resize((size_t)count * dim * 4);
+        if (!readAll(fd, payload.data(), payload.size()))
+          break;
+        received += count;
+
+        if (reply)
+        {
+          op = received >= records ? OPCODE_QUIT : OPCODE_DONE;
+          if (write(fd, &op, 1) != 1 || op == OPCODE_QUIT)
+            break;
+        }
+      }
+      close(fd);
+    }
+
+  public:
+    Sink()
+    {
+      struct sockaddr_in addr;
+      socklen_t len;
+      int one = 1;
+
+      this->sock = socket(AF_INET, SOCK_STREAM, 0);
+      setsockopt(this->sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+      memset(&addr, 0, sizeof(addr));
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      addr.sin_port = 0;
+      len = sizeof(addr);
+      if (bind(this->sock, (struct sockaddr *)&addr, sizeof(addr)) < 0
+          || listen(this->sock, 64) < 0
+          || getsockname(this->sock, (struct sockaddr *)&addr, &len) < 0)
+      {
+        perror("sink");
+        exit(1);
+      }
+      this->port = ntohs(addr.sin_port);
+    }
+
+    ~Sink()
+    {
+      for (auto &r : this->readers)
+        r.join();
+      close(this->sock);
+    }
+
+    int getPort()
+    {
+      return this->port;
+    }
+
+    void start(int conns, bool reply, long records)
+    {
+      int sock = this->sock;
+
+      for (int i=0; i<conns; i++)
+        this->readers.emplace_back([sock, reply, records]() {
+          int fd = accept(sock, NULL, NULL);
+          if (fd >= 0)
+            serve(fd, reply, records);
+        });
+    }
+};
+
+// A DataSet of 'customers' houses with random readings, as produced by
+// the DataReceiver
+static DataSet *synthetic(const struct config *cfg, time_t ts, unsigned int *rng)
+{
+  DataSet *ds;
+  float *column;
+  int hours, n;
+
+  hours = cfg->hourly ? 24 : 1;
+  n = cfg->customers * hours;
+  column = new float[n];
+  for (int i=0; i<n; i++)
+    column[i] = (float)(rand_r(rng) % 1000) / (hours == 1 ? 1.0f : 24.0f);
+
+  ds = new DataSet(ts);
+  ds->setTemperatureData(TemperatureData(ts, -2.5, 6.1, 1.4));
+  ds->setHumidityData(HumidityData(ts, 35, 80, 64.87));
+  ds->setNumHouseData(cfg->customers);
+  ds->setPowerColumn(column, hours, true);
+  return ds;
+}
+
+// ====== Stages ======
+static struct result bench_get_dataset(const struct config *cfg)
+{
+  struct result r = { "getDataSet", cfg->customers, (long)cfg->ops * cfg->threads, 0, {0, 0, 0}, {} };
+  vector<DataReceiver *> dr(cfg->threads);
+
+  for (int t=0; t<cfg->threads; t++)
+  {
+    dr[t] = new DataReceiver();
+    dr[t]->setSeed(cfg->seed + t);
+    dr[t]->setHourly(cfg->hourly);
+    dr[t]->setNumOfCustomer(cfg->customers);
+    dr[t]->init();
+  }
+
+  r.seconds = parallel(cfg->threads, &r.alloc, [&](int t) {
+    for (int i=0; i<cfg->ops; i++)
+      delete dr[t]->getDataSet(START_TIME + (time_t)i * DAY);
+  });
+
+  for (auto d : dr)
+    delete d;
+  return r;
+}
+
+static struct result bench_process_data(const struct config *cfg)
+{
+  struct result r = { "processData", cfg->customers, (long)cfg->ops * cfg->threads, 0, {0, 0, 0}, {} };
+  vector<vector<DataSet *>> pool(cfg->threads);
+  vector<ProcessManager *> pm(cfg->threads);
+
+  for (int t=0; t<cfg->threads; t++)
+  {
+    unsigned int rng = cfg->seed + t;
+    for (int i=0; i<POOL; i++)
+      pool[t].push_back(synthetic(cfg, START_TIME + (time_t)i * DAY, &rng));
+    pm[t] = new ProcessManager();
+    pm[t]->setVectorID(cfg->vector_id);
+  }
+
+  r.seconds = parallel(cfg->threads, &r.alloc, [&](int t) {
+    uint8_t buf[BUFLEN];
+    for (int i=0; i<cfg->ops; i++)
+      pm[t]->processData(pool[t][i % POOL], buf);
+  });
+
+  for (int t=0; t<cfg->threads; t++)
+  {
+    for (auto ds : pool[t])
+      delete ds;
+    delete pm[t];
+  }
+  return r;
+}
+
+static struct result bench_send_data(const struct config *cfg)
+{
+  struct result r = { "sendData", 0, (long)cfg->ops * cfg->threads, 0, {0, 0, 0}, {} };
+  vector<NetworkManager *> nm(cfg->threads);
+  float features[NUM_OF_FEATURES] = { 0 };
+  uint8_t data[BUFLEN];
+  int dlen;
+
+  dlen = vector_table[cfg->vector_id].encode(features, data);
+  {
+    Sink sink;
+
+    sink.start(cfg->threads, false, 0);
+    for (int t=0; t<cfg->threads; t++)
+    {
+      nm[t] = new NetworkManager("127.0.0.1", sink.getPort());
+      nm[t]->init();
+    }
+
+    r.seconds = parallel(cfg->threads, &r.alloc, [&](int t) {
+      for (int i=0; i<cfg->ops; i++)
+        nm[t]->sendData(data, dlen, cfg->vector_id);
+    });
+
+    // closing the connections ends the sink's readers
+    for (auto n : nm)
+      delete n;
+  }
+  return r;
+}
+
+static struct result bench_run(const struct config *cfg)
+{
+  struct result r = { "Edge::run", cfg->customers, (long)cfg->ops * cfg->threads, 0, {0, 0, 0}, {} };
+  vector<Edge *> edges(cfg->threads);
+  Sink sink;
+
+  sink.start(cfg->threads, true, cfg->ops);
+  for (int t=0; t<cfg->threads; t++)
+  {
+    edges[t] = new Edge("127.0.0.1", sink.getPort());
+    edges[t]->setSeed(cfg->seed + t);
+    edges[t]->setHourly(cfg->hourly);
+    edges[t]->setBatchSize(cfg->batch);
+    edges[t]->setNumOfCustomer(cfg->customers);
+    edges[t]->setHistory(cfg->history_days > 0);
+    edges[t]->setHistoryDays(cfg->history_days);
+    edges[t]->init();
+    edges[t]->setVectorID(cfg->vector_id);
+  }
+
+  r.seconds = parallel(cfg->threads, &r.alloc, [&](int t) {
+    edges[t]->run();
+  });
+
+  // with batching the last frame may carry a few extra days
+  r.ops = (long)((cfg->ops + cfg->batch - 1) / cfg->batch) * cfg->batch * cfg->threads;
+  for (auto e : edges)
+    delete e;
+  return r;
+}
+
+// Per-probe latency of the stage (see edge/metrics.h), as
+// "latency_ns": {"process": {"p50": .., "p99": .., "max": ..}, ...}
+static void print_latency(FILE *out, const struct result *r)
+{
+  bool first = true;
+
+  fprintf(out, ", \"latency_ns\": {");
+  for (int i=0; i<NUM_OF_TIMERS; i++)
+  {
+    const struct histogram_summary *h = &r->latency[i];
+
+    if (h->count == 0)
+      continue;
+    fprintf(out, "%s\"%s\": {\"count\": %lu, \"mean\": %.1f, \"p50\": %lu, \"p99\": %lu, \"max\": %lu}",
+        first ? "" : ", ", metrics_timer_name((enum metric_timer)i), (unsigned long)h->count,
+        (double)h->sum / h->count, (unsigned long)h->p50, (unsigned long)h->p99, (unsigned long)h->max);
+    first = false;
+  }
+  fprintf(out, "}");
+}
+
+static void print_result(FILE *out, const struct result *r, const struct config *cfg, bool last)
+{
+  double ns;
+
+  ns = r->seconds * 1e9 * cfg->threads / r->ops;
+  fprintf(out, "    {\"stage\": \"%s\", \"customers\": %d, \"threads\": %d, \"ops\": %ld, "
+      "\"seconds\": %.6f, \"ns_per_op\": %.1f, \"ops_per_sec\": %.1f, "
+      "\"allocs_per_op\": %.2f, \"alloc_bytes_per_op\": %.1f, \"frees_per_op\": %.2f",
+      r->stage, r->customers, cfg->threads, r->ops, r->seconds, ns, r->ops / r->seconds,
+      (double)r->alloc.count / r->ops, (double)r->alloc.bytes / r->ops,
+      (double)r->alloc.frees / r->ops);
+  print_latency(out, r);
+  fprintf(out, "}%s\n", last ? "" : ",");
+}
+
+// Runs one stage with the edge probes zeroed first
+static struct result run_stage(struct result (*stage)(const struct config *), const struct config *cfg)
+{
+  struct result r;
+
+  metrics_reset();
+  r = stage(cfg);
+  for (int i=0; i<NUM_OF_TIMERS; i++)
+    metrics_summary((enum metric_timer)i, &r.latency[i]);
+  return r;
+}
+
+static void usage(const char *pname)
+{
+  printf(">> Usage: %s [options]\n", pname);
+  printf("Options\n");
+  printf("  -c, --customers  Houses per DataSet (default: %d)\n", NUM_OF_CUSTOMER);
+  printf("  -v, --vector     Vector id (default: 2)\n");
+  printf("  -t, --threads    Threads, each with its own pipeline (default: 1)\n");
+  printf("  -n, --ops        Operations (days) per thread and stage (default: 1000)\n");
+  printf("  -b, --batch      Days per frame for Edge::run (default: 1)\n");
+  printf("  -d, --history-days  Days of history per house for Edge::run (default: 0, none)\n");
+  printf("  -H, --hourly     24 readings per house per day\n");
+  printf("  -s, --stages     Comma-separated subset of get,process,send,run (default: all)\n");
+  printf("  -o, --output     Write the JSON to a file instead of stdout\n");
+  exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+  struct config cfg = { NUM_OF_CUSTOMER, 2, 1, 1000, 1, false, 1, 0 };
+  const char *output = NULL;
+  string stages = "get,process,send,run";
+  vector<struct result> results;
+  FILE *out;
+  int c;
+
+  static struct option long_options[] = {
+    {"customers", required_argument, 0, 'c'},
+    {"vector", required_argument, 0, 'v'},
+    {"threads", required_argument, 0, 't'},
+    {"ops", required_argument, 0, 'n'},
+    {"batch", required_argument, 0, 'b'},
+    {"history-days", required_argument, 0, 'd'},
+    {"hourly", no_argument, 0, 'H'},
+    {"stages", required_argument, 0, 's'},
+    {"output", required_argument, 0, 'o'},
+    {0, 0, 0, 0}
+  };
+
+  while ((c = getopt_long(argc, argv, "c:v:t:n:b:d:Hs:o:", long_options, NULL)) != -1)
+  {
+    switch (c)
+    {
+      case 'c': cfg.customers = atoi(optarg); break;
+      case 'v': cfg.vector_id = atoi(optarg); break;
+      case 't': cfg.threads = atoi(optarg); break;
+      case 'n': cfg.ops = atoi(optarg); break;
+      case 'b': cfg.batch = atoi(optarg); break;
+      case 'd': cfg.history_days = atoi(optarg); break;
+      case 'H': cfg.hourly = true; break;
+      case 's': stages = optarg; break;
+      case 'o': output = optarg; break;
+      default: usage(argv[0]);
+    }
+  }
+
+  if (cfg.customers < 1 || cfg.customers > MAX_CUSTOMERS || cfg.threads < 1 || cfg.ops < 1 || cfg.batch < 1 || cfg.history_days < 0
+      || cfg.batch > BATCH_MAX || cfg.vector_id < 0 || cfg.vector_id >= NUM_OF_VECTORS)
+    usage(argv[0]);
+
+  // the edge's own messages would interleave with the JSON
+  log_set_level(LOG_LEVEL_WARN);
+
+  stages = "," + stages + ",";
+  if (stages.find(",get,") != string::npos)
+    results.push_back(run_stage(bench_get_dataset, &cfg));
+  if (stages.find(",process,") != string::npos)
+    results.push_back(run_stage(bench_process_data, &cfg));
+  if (stages.find(",send,") != string::npos)
+    results.push_back(run_stage(bench_send_data, &cfg));
+  if (stages.find(",run,") != string::npos)
+    results.push_back(run_stage(bench_run, &cfg));
+
+  out = output ? fopen(output, "w") : stdout;
+  if (!out)
+  {
+    perror(output);
+    return 1;
+  }
+
+  fprintf(out, "{\n  \"bench\": \"edge\",\n");
+  fprintf(out, "  \"config\": {\"customers\": %d, \"vector_id\": %d, \"threads\": %d, "
+      "\"ops\": %d, \"batch\": %d, \"hourly\": %s, \"history_days\": %d},\n",
+      cfg.customers, cfg.vector_id, cfg.threads, cfg.ops, cfg.batch, cfg.hourly ? "true" : "false",
+      cfg.history_days);
+  fprintf(out, "  \"results\": [\n");
+  for (size_t i=0; i<results.size(); i++)
+    print_result(out, &results[i], &cfg, i + 1 == results.size());
+  fprintf(out, "  ]\n}\n");
+
+  if (output)
+    fclose(out);
+  return 0;
+}
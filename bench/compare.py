@@ -0,0 +1,40 @@
+#!/usr/bin/env python3
+"""
+Compares bench_edge JSON results: prints ns/op per stage for every file
+and the speedup against the first one.
+
+    python3 compare.py baseline.json candidate.json [...]
+"""
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {r["stage"]: r for r in json.load(f)["results"]}
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip())
+        return 1
+
+    runs = [(path, load(path)) for path in sys.argv[1:]]
+    base = runs[0][1]
+
+    print("{:<14}".format("stage") + "".join("{:>26}".format(p) for p, _ in runs))
+    for stage in base:
+        line = "{:<14}".format(stage)
+        for _, results in runs:
+            r = results.get(stage)
+            if r is None:
+                line += "{:>26}".format("-")
+                continue
+            speedup = base[stage]["ns_per_op"] / r["ns_per_op"]
+            line += "{:>17.1f} (x{:>5.2f})".format(r["ns_per_op"], speedup)
+        print(line)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""
+Scaling sweep of the edge data path: runs bench_edge for every customer
+count, thread count and vector id, one process per run so the peak RSS
+is that run's own, and prints a comparison table. Adjacent customer
+counts are compared: a stage whose time per day, or a run whose peak RSS,
+grows faster than the customer count (log-log slope above --threshold)
+is flagged as super-linear.
+
+    python3 scale.py [--customers 1000,10000,...] [--threads 1,2]
+                     [--vectors 0,1,2] [--stages get,process,run]
+                     [--repeat N] [-o scale.json] [--strict]
+"""
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# The edge probe that times each bench_edge stage (see edge/metrics.h)
+PROBE = {
+    "getDataSet": "generate",
+    "processData": "process",
+    "sendData": "send",
+    "Edge::run": "iteration",
+}
+
+
+def ints(text):
+    return [int(v) for v in text.split(",") if v]
+
+
+def ops_for(customers, args):
+    # about the same number of house-days for every customer count
+    return max(args.min_ops, min(args.max_ops, args.work // customers))
+
+
+def run_one(customers, threads, vector_id, args):
+    """One bench_edge process; returns (results, peak RSS in KB) or None"""
+    with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as tmp:
+        path = tmp.name
+    cmd = [args.bench, "-c", str(customers), "-t", str(threads), "-v", str(vector_id),
+           "-n", str(ops_for(customers, args)), "-d", str(args.history_days),
+           "-s", args.stages, "-o", path]
+    if args.hourly:
+        cmd.append("-H")
+
+    proc = subprocess.Popen(cmd)
+    _, status, usage = os.wait4(proc.pid, 0)
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    try:
+        if proc.returncode != 0:
+            print("[!] {} exited with {}".format(" ".join(cmd), proc.returncode), file=sys.stderr)
+            return None
+        with open(path) as f:
+            results = json.load(f)["results"]
+    finally:
+        os.unlink(path)
+    return results, usage.ru_maxrss
+
+
+def slope(x1, y1, x2, y2):
+    if x1 <= 0 or x2 <= 0 or y1 <= 0 or y2 <= 0 or x1 == x2:
+        return 0.0
+    return math.log(y2 / y1) / math.log(x2 / x1)
+
+
+def sweep(args):
+    rows = []
+    for threads in args.threads:
+        for vector_id in args.vectors:
+            for customers in args.customers:
+                print("[*] customers={} threads={} vector={}".format(customers, threads, vector_id),
+                      file=sys.stderr)
+                best = None
+                for _ in range(args.repeat):
+                    ret = run_one(customers, threads, vector_id, args)
+                    if ret is None:
+                        break
+                    if best is None:
+                        best = ret
+                    else:
+                        # fastest time per stage, largest RSS
+                        fastest = {r["stage"]: r for r in best[0]}
+                        for r in ret[0]:
+                            if r["ns_per_op"] < fastest[r["stage"]]["ns_per_op"]:
+                                fastest[r["stage"]] = r
+                        best = (list(fastest.values()), max(best[1], ret[1]))
+                if best is None:
+                    # larger runs would fail the same way
+                    break
+                results, rss = best
+                for r in results:
+                    probe = r.get("latency_ns", {}).get(PROBE.get(r["stage"], ""), {})
+                    rows.append({
+                        "customers": customers, "threads": threads, "vector_id": vector_id,
+                        "stage": r["stage"], "ops": r["ops"], "ns_per_op": r["ns_per_op"],
+                        "house_days_per_sec": r["ops_per_sec"] * customers,
+                        "p50_ns": probe.get("p50", 0), "p99_ns": probe.get("p99", 0),
+                        "allocs_per_op": r["allocs_per_op"], "peak_rss_kb": rss,
+                    })
+    return rows
+
+
+def time_series(rows):
+    series = {}
+    for r in rows:
+        series.setdefault((r["threads"], r["vector_id"], r["stage"]), []).append(r)
+    for points in series.values():
+        points.sort(key=lambda r: r["customers"])
+    return sorted(series.items())
+
+
+def rss_series(rows):
+    # peak RSS is per run, so one series per (threads, vector_id)
+    memory = {}
+    for r in rows:
+        memory.setdefault((r["threads"], r["vector_id"]), {})[r["customers"]] = r["peak_rss_kb"]
+    return [(key, sorted(points.items())) for key, points in sorted(memory.items())]
+
+
+def flag_growth(rows, threshold):
+    flags = []
+
+    for (threads, vector_id, stage), points in time_series(rows):
+        for a, b in zip(points, points[1:]):
+            k = slope(a["customers"], a["ns_per_op"], b["customers"], b["ns_per_op"])
+            if k > threshold:
+                flags.append("time  {:<12} threads={} vector={}: {} -> {} customers, "
+                             "ns/day x{:.1f} (slope {:.2f})".format(
+                                 stage, threads, vector_id, a["customers"], b["customers"],
+                                 b["ns_per_op"] / a["ns_per_op"], k))
+
+    for (threads, vector_id), points in rss_series(rows):
+        for (n1, m1), (n2, m2) in zip(points, points[1:]):
+            k = slope(n1, m1, n2, m2)
+            if k > threshold:
+                flags.append("rss   threads={} vector={}: {} -> {} customers, "
+                             "peak RSS x{:.1f} (slope {:.2f})".format(
+                                 threads, vector_id, n1, n2, m2 / m1, k))
+    return flags
+
+
+def print_table(rows):
+    header = "{:>10} {:>3} {:>3} {:<12} {:>7} {:>14} {:>16} {:>11} {:>11} {:>8} {:>10}".format(
+        "customers", "thr", "vec", "stage", "days", "ns/day", "house-days/s",
+        "p50 us", "p99 us", "allocs", "peak MB")
+    print(header)
+    print("-" * len(header))
+    for r in rows:
+        print("{:>10} {:>3} {:>3} {:<12} {:>7} {:>14.0f} {:>16.0f} {:>11.1f} {:>11.1f} {:>8.2f} {:>10.1f}".format(
+            r["customers"], r["threads"], r["vector_id"], r["stage"], r["ops"], r["ns_per_op"],
+            r["house_days_per_sec"], r["p50_ns"] / 1e3, r["p99_ns"] / 1e3,
+            r["allocs_per_op"], r["peak_rss_kb"] / 1024))
+
+
+def print_growth(rows):
+    print("Growth between adjacent customer counts (log-log slope; 1.00 = linear):")
+    for (threads, vector_id, stage), points in time_series(rows):
+        slopes = [slope(a["customers"], a["ns_per_op"], b["customers"], b["ns_per_op"])
+                  for a, b in zip(points, points[1:])]
+        print("  threads={} vector={} {:<12} time {}".format(
+            threads, vector_id, stage, " ".join("{:5.2f}".format(k) for k in slopes)))
+    for (threads, vector_id), points in rss_series(rows):
+        slopes = [slope(n1, m1, n2, m2) for (n1, m1), (n2, m2) in zip(points, points[1:])]
+        print("  threads={} vector={} {:<12} rss  {}".format(
+            threads, vector_id, "", " ".join("{:5.2f}".format(k) for k in slopes)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Scaling sweep of the edge data path")
+    parser.add_argument("--customers", type=ints, default=[1000, 10000, 100000, 1000000, 10000000])
+    parser.add_argument("--threads", type=ints, default=sorted({1, os.cpu_count() or 1}))
+    parser.add_argument("--vectors", type=ints, default=[0, 1, 2])
+    parser.add_argument("--stages", default="get,process,run")
+    parser.add_argument("--hourly", action="store_true")
+    parser.add_argument("--history-days", type=int, default=7,
+                        help="history kept by Edge::run (days x customers floats)")
+    parser.add_argument("--work", type=int, default=20000000,
+                        help="house-days per thread and run; sets the days per run")
+    parser.add_argument("--min-ops", type=int, default=3)
+    parser.add_argument("--max-ops", type=int, default=20000)
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="runs per point; the fastest is kept (noise on small sizes)")
+    parser.add_argument("--threshold", type=float, default=1.3,
+                        help="log-log slope above which growth is flagged; caches and "
+                        "page faults alone give 1.1-1.3 past ~1M customers, O(n^2) gives 2")
+    parser.add_argument("--bench", default=os.path.join(HERE, "bench_edge"))
+    parser.add_argument("-o", "--output", help="also write the rows and flags as JSON")
+    parser.add_argument("--strict", action="store_true", help="exit 1 when anything is flagged")
+    args = parser.parse_args()
+
+    rows = sweep(args)
+    flags = flag_growth(rows, args.threshold)
+
+    print_table(rows)
+    print()
+    print_growth(rows)
+    print()
+    if flags:
+        print("Super-linear growth:")
+        for f in flags:
+            print("  " + f)
+    else:
+        print("No super-linear growth (slope threshold {:.2f})".format(args.threshold))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({"rows": rows, "flags": flags}, f, indent=2)
+
+    return 1 if args.strict and flags else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""
+Sustained throughput of the collector's http sink (or server.py) against
+a slow AI module: a stub AI module answers every request after --latency
+seconds, and one edge-like client sends --vectors vectors one per frame
+(the edge's -b 1), waiting for each ack. The run uses many more vectors
+than --queue requests can hold, so the queue fills and the vectors per
+PUT decide the throughput. Prints the acked and delivered rates per
+quarter of the run, and the vectors per PUT.
+
+    python3 sink.py [--server] [--vectors N] [--latency SEC]
+                    [--queue N] [--batch N]
+"""
+import argparse
+import json
+import os
+import socket
+import struct
+import subprocess
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SERVER_DIR = os.path.join(HERE, "..", "server")
+
+OPCODE_DATA = 1
+OPCODE_DONE = 3
+OPCODE_QUIT = 4
+
+
+class StubAI(BaseHTTPRequestHandler):
+    """The AI module's endpoints, each answered after the latency"""
+
+    protocol_version = "HTTP/1.1"
+    disable_nagle_algorithm = True
+    latency = 0.0
+    lock = threading.Lock()
+    start = 0.0
+    puts = 0
+    vectors = 0
+    received = []             # (vectors so far, seconds since start)
+
+    def log_message(self, *args):
+        pass
+
+    def reply(self, obj):
+        body = json.dumps(obj).encode()
+        self.send_response(200)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def body(self):
+        return self.rfile.read(int(self.headers.get("Content-Length", 0)))
+
+    def do_POST(self):
+        self.body()
+        time.sleep(self.latency)
+        self.reply({"opcode": "success"})
+
+    def do_PUT(self):
+        # the body is a JSON string holding the JSON object
+        values = json.loads(json.loads(self.body()))["values"]
+        time.sleep(self.latency)
+        with StubAI.lock:
+            StubAI.puts += 1
+            StubAI.vectors += len(values)
+            StubAI.received.append((StubAI.vectors, time.time() - StubAI.start))
+        self.reply({"opcode": "success"})
+
+    def do_GET(self):
+        self.reply({"opcode": "success", "accuracy": 0, "correct": 0, "incorrect": 0})
+
+
+def free_port():
+    with socket.socket() as s:
+        s.bind(("127.0.0.1", 0))
+        return s.getsockname()[1]
+
+
+def connect(port, timeout=10):
+    deadline = time.time() + timeout
+    while True:
+        try:
+            return socket.create_connection(("127.0.0.1", port))
+        except OSError:
+            if time.time() > deadline:
+                raise
+            time.sleep(0.05)
+
+
+def start_target(args, port, ai_port):
+    if args.server:
+        cmd = [sys.executable, os.path.join(SERVER_DIR, "server.py"), "--name", "bench",
+               "--algorithm", "bench", "--lport", str(port), "--caddr", "127.0.0.1",
+               "--cport", str(ai_port), "--ntrain", str(args.vectors), "--ntest", "0",
+               "--batch", str(args.batch), "--queue", str(args.queue)]
+    else:
+        cmd = [args.collector, "-p", str(port), "-a", "127.0.0.1", "-k", "http",
+               "-n", "bench", "-A", "bench", "-c", "127.0.0.1", "-C", str(ai_port),
+               "-T", str(args.vectors), "-E", "0", "-b", str(args.batch), "-q", str(args.queue)]
+    return subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+def run(args):
+    """Returns when every vector was acked and when each quarter of them
+    reached the AI module (seconds since the first frame)"""
+    with open(os.path.join(SERVER_DIR, "vector_info.json")) as f:
+        dim = json.load(f)["0"]["dim"]
+    frame = bytes([OPCODE_DATA, 0]) + struct.pack(">{}f".format(dim), *([1.0] * dim))
+
+    acked = []
+    sock = connect(args.port)
+    start = StubAI.start = time.time()
+    for i in range(args.vectors):
+        sock.sendall(frame)
+        ack = sock.recv(1)
+        if not ack or ack[0] not in (OPCODE_DONE, OPCODE_QUIT):
+            print("[!] No ack for vector {}".format(i), file=sys.stderr)
+            break
+        acked.append(time.time() - start)
+    sock.close()
+
+    # the partial batches are flushed within the sink's flush interval
+    deadline = time.time() + 30
+    while time.time() < deadline:
+        with StubAI.lock:
+            if StubAI.vectors >= len(acked):
+                break
+        time.sleep(0.01)
+
+    delivered = []
+    marks = [args.vectors * (k + 1) // 4 for k in range(4)]
+    with StubAI.lock:
+        for n, when in StubAI.received:
+            while marks and n >= marks[0]:
+                delivered.append((marks.pop(0), when))
+    return acked, delivered
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Sustained throughput of the http sink")
+    parser.add_argument("--server", action="store_true", help="benchmark server.py instead")
+    parser.add_argument("--vectors", type=int, default=20000)
+    parser.add_argument("--latency", type=float, default=0.02, help="seconds per AI request")
+    parser.add_argument("--queue", type=int, default=16, help="requests queued before waiting")
+    parser.add_argument("--batch", type=int, default=64, help="vectors per PUT")
+    parser.add_argument("--collector", default=os.path.join(SERVER_DIR, "collector", "collector"))
+    args = parser.parse_args()
+
+    StubAI.latency = args.latency
+    ai = ThreadingHTTPServer(("127.0.0.1", 0), StubAI)
+    threading.Thread(target=ai.serve_forever, daemon=True).start()
+
+    args.port = free_port()
+    target = start_target(args, args.port, ai.server_address[1])
+    try:
+        acked, delivered = run(args)
+    finally:
+        target.terminate()
+        target.wait()
+        ai.shutdown()
+
+    print("{} vectors, one per frame, AI latency {:.0f} ms, --queue {}, --batch {} ({})".format(
+        args.vectors, args.latency * 1e3, args.queue, args.batch,
+        "server.py" if args.server else "collector"))
+    print("{:>10} {:>12} {:>16} {:>12} {:>16}".format(
+        "vectors", "acked s", "acked vec/s", "delivered s", "delivered vec/s"))
+    prev = (0, 0.0, 0.0)
+    for n, when in delivered:
+        t = acked[n - 1] if n <= len(acked) else float("nan")
+        print("{:>10} {:>12.2f} {:>16.0f} {:>12.2f} {:>16.0f}".format(
+            n, t, (n - prev[0]) / max(t - prev[1], 1e-9),
+            when, (n - prev[0]) / max(when - prev[2], 1e-9)))
+        prev = (n, t, when)
+    with StubAI.lock:
+        print("{} PUTs, {:.1f} vectors per PUT".format(
+            StubAI.puts, StubAI.vectors / max(StubAI.puts, 1)))
+
+    return 0 if len(acked) == args.vectors and len(delivered) == 4 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
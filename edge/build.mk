@@ -0,0 +1,45 @@
+# Build modes shared by edge/, edge/data/ and bench/; EDGE_DIR must point
+# to edge/ before this file is included.
+#
+#   make                     release: -O3, LTO, -march=$(MARCH)
+#   make MARCH=x86-64-v2     release for a portable target
+#   make MODE=debug          -O0 -g with AddressSanitizer and UBSan
+#   make METRICS=0           compile the hot-path metrics probes out
+#   make pgo                 (edge/ only) instrumented build, bench workload,
+#                            then a rebuild with the collected profiles
+#
+# Switching modes needs a 'make clean' first
+
+MODE ?= release
+MARCH ?= native
+METRICS ?= 1
+PGO_DIR ?= $(abspath $(EDGE_DIR))/pgo
+
+COMMON_CXXFLAGS = -MMD -MP -pthread -DEDGE_METRICS=$(METRICS)
+
+ifeq ($(MODE),release)
+  MODE_CXXFLAGS = -O3 -march=$(MARCH) -flto=auto -ffat-lto-objects -DNDEBUG
+  MODE_LDFLAGS = -O3 -march=$(MARCH) -flto=auto
+else ifeq ($(MODE),debug)
+  MODE_CXXFLAGS = -O0 -g -fsanitize=address,undefined -fno-omit-frame-pointer
+  MODE_LDFLAGS = -fsanitize=address,undefined
+else ifeq ($(MODE),pgo-gen)
+  MODE_CXXFLAGS = -O3 -march=$(MARCH) -DNDEBUG -fprofile-generate=$(PGO_DIR) -fprofile-update=atomic
+  MODE_LDFLAGS = -fprofile-generate=$(PGO_DIR)
+else ifeq ($(MODE),pgo-use)
+  MODE_CXXFLAGS = -O3 -march=$(MARCH) -flto=auto -ffat-lto-objects -DNDEBUG \
+    -fprofile-use=$(PGO_DIR) -fprofile-correction -Wno-missing-profile
+  MODE_LDFLAGS = -O3 -march=$(MARCH) -flto=auto
+else ifeq ($(MODE),plain)
+  # the flags the tree used to build with (none)
+  MODE_CXXFLAGS =
+  MODE_LDFLAGS =
+else
+  $(error unknown MODE '$(MODE)': use release, debug, pgo-gen, pgo-use or plain)
+endif
+
+CXXFLAGS += $(COMMON_CXXFLAGS) $(MODE_CXXFLAGS)
+LDFLAGS += -pthread $(MODE_LDFLAGS)
+
+# archives of LTO objects need the plugin-aware ar
+AR = gcc-ar
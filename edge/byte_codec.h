@@ -0,0 +1,229 @@
+#ifndef __BYTE_CODEC_H__
+#define __BYTE_CODEC_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+#if defined(__cpp_lib_bit_cast)
+#include <bit>
+#endif
+
+// Big-endian (network order) encoding of integers and IEEE-754 floats.
+// Every access goes through memcpy of the whole value, so the pointers
+// may be unaligned and of any byte type, and the compiler emits a single
+// load/store plus bswap (movbe) instead of four byte stores
+
+// Reinterprets the bits of a value as another type of the same size
+template <class To, class From>
+inline To bit_cast_value(const From &from)
+{
+  static_assert(sizeof(To) == sizeof(From), "bit_cast between different sizes");
+#if defined(__cpp_lib_bit_cast)
+  return std::bit_cast<To>(from);
+#else
+  To to;
+  memcpy(&to, &from, sizeof(To));
+  return to;
+#endif
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+inline constexpr uint16_t to_be16(uint16_t v) { return v; }
+inline constexpr uint32_t to_be32(uint32_t v) { return v; }
+inline constexpr uint64_t to_be64(uint64_t v) { return v; }
+#else
+inline constexpr uint16_t to_be16(uint16_t v) { return __builtin_bswap16(v); }
+inline constexpr uint32_t to_be32(uint32_t v) { return __builtin_bswap32(v); }
+inline constexpr uint64_t to_be64(uint64_t v) { return __builtin_bswap64(v); }
+#endif
+
+// ====== Stores; p receives the bytes in big-endian order ======
+inline void put_be8(void *p, uint8_t v)
+{
+  *(uint8_t *)p = v;
+}
+
+inline void put_be16(void *p, uint16_t v)
+{
+  v = to_be16(v);
+  memcpy(p, &v, 2);
+}
+
+inline void put_be32(void *p, uint32_t v)
+{
+  v = to_be32(v);
+  memcpy(p, &v, 4);
+}
+
+inline void put_be64(void *p, uint64_t v)
+{
+  v = to_be64(v);
+  memcpy(p, &v, 8);
+}
+
+inline void put_be_f32(void *p, float v)
+{
+  put_be32(p, bit_cast_value<uint32_t>(v));
+}
+
+// ====== Loads ======
+inline uint8_t get_be8(const void *p)
+{
+  return *(const uint8_t *)p;
+}
+
+inline uint16_t get_be16(const void *p)
+{
+  uint16_t v;
+
+  memcpy(&v, p, 2);
+  return to_be16(v);
+}
+
+inline uint32_t get_be32(const void *p)
+{
+  uint32_t v;
+
+  memcpy(&v, p, 4);
+  return to_be32(v);
+}
+
+inline uint64_t get_be64(const void *p)
+{
+  uint64_t v;
+
+  memcpy(&v, p, 8);
+  return to_be64(v);
+}
+
+inline float get_be_f32(const void *p)
+{
+  return bit_cast_value<float>(get_be32(p));
+}
+
+// ====== Bulk float columns ======
+// Plain loops over whole words; the compiler vectorizes the byte swap
+inline void put_be_f32_array(void *dst, const float *src, size_t n)
+{
+  uint8_t *p = (uint8_t *)dst;
+
+  for (size_t i=0; i<n; i++)
+    put_be_f32(p + 4 * i, src[i]);
+}
+
+inline void get_be_f32_array(float *dst, const void *src, size_t n)
+{
+  const uint8_t *p = (const uint8_t *)src;
+
+  for (size_t i=0; i<n; i++)
+    dst[i] = get_be_f32(p + 4 * i);
+}
+
+// Bounded sequential writer over a caller's buffer. A write that does not
+// fit sets the failure flag and leaves the buffer untouched, so a frame
+// can be built with unchecked calls and validated once with ok()
+class ByteWriter
+{
+  private:
+    uint8_t *base;
+    size_t cap;
+    size_t off;
+    bool failed;
+
+    inline uint8_t *take(size_t len)
+    {
+      uint8_t *p;
+
+      if (this->failed || len > this->cap - this->off)
+      {
+        this->failed = true;
+        return NULL;
+      }
+      p = this->base + this->off;
+      this->off += len;
+      return p;
+    }
+
+  public:
+    ByteWriter(void *buf, size_t len)
+      : base((uint8_t *)buf), cap(len), off(0), failed(false) {}
+
+    inline void u8(uint8_t v) { uint8_t *p = take(1); if (p) put_be8(p, v); }
+    inline void u16(uint16_t v) { uint8_t *p = take(2); if (p) put_be16(p, v); }
+    inline void u32(uint32_t v) { uint8_t *p = take(4); if (p) put_be32(p, v); }
+    inline void u64(uint64_t v) { uint8_t *p = take(8); if (p) put_be64(p, v); }
+    inline void f32(float v) { uint8_t *p = take(4); if (p) put_be_f32(p, v); }
+
+    inline void f32_array(const float *src, size_t n)
+    {
+      uint8_t *p = take(4 * n);
+      if (p)
+        put_be_f32_array(p, src, n);
+    }
+
+    inline void bytes(const void *src, size_t len)
+    {
+      uint8_t *p = take(len);
+      if (p)
+        memcpy(p, src, len);
+    }
+
+    inline uint8_t *data() { return this->base; }
+    inline size_t size() { return this->off; }
+    inline size_t remaining() { return this->cap - this->off; }
+    inline bool ok() { return !this->failed; }
+};
+
+// Bounded sequential reader; reading past the end returns zeros and sets
+// the failure flag
+class ByteReader
+{
+  private:
+    const uint8_t *base;
+    size_t cap;
+    size_t off;
+    bool failed;
+
+    inline const uint8_t *take(size_t len)
+    {
+      const uint8_t *p;
+
+      if (this->failed || len > this->cap - this->off)
+      {
+        this->failed = true;
+        return NULL;
+      }
+      p = this->base + this->off;
+      this->off += len;
+      return p;
+    }
+
+  public:
+    ByteReader(const void *buf, size_t len)
+      : base((const uint8_t *)buf), cap(len), off(0), failed(false) {}
+
+    inline uint8_t u8() { const uint8_t *p = take(1); return p ? get_be8(p) : 0; }
+    inline uint16_t u16() { const uint8_t *p = take(2); return p ? get_be16(p) : 0; }
+    inline uint32_t u32() { const uint8_t *p = take(4); return p ? get_be32(p) : 0; }
+    inline uint64_t u64() { const uint8_t *p = take(8); return p ? get_be64(p) : 0; }
+    inline float f32() { const uint8_t *p = take(4); return p ? get_be_f32(p) : 0; }
+
+    inline bool f32_array(float *dst, size_t n)
+    {
+      const uint8_t *p = take(4 * n);
+      if (p)
+        get_be_f32_array(dst, p, n);
+      return p != NULL;
+    }
+
+    inline size_t size() { return this->off; }
+    inline size_t remaining() { return this->cap - this->off; }
+    inline bool ok() { return !this->failed; }
+};
+
+#endif /* __BYTE_CODEC_H__ */
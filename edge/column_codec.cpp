@@ -0,0 +1,162 @@
+#include <atomic>
+#include <cstring>
+#include "column_codec.h"
+#include "setting.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLUMN_CODEC_X86
+#endif
+
+typedef void (*swap_fn)(uint8_t *dst, const uint8_t *src, size_t n);
+
+static void swap_scalar(uint8_t *dst, const uint8_t *src, size_t n)
+{
+  uint32_t v;
+
+  for (size_t i=0; i<n; i++)
+  {
+    memcpy(&v, src + 4 * i, 4);
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    memcpy(dst + 4 * i, &v, 4);
+  }
+}
+
+#ifdef COLUMN_CODEC_X86
+__attribute__((target("ssse3")))
+static void swap_ssse3(uint8_t *dst, const uint8_t *src, size_t n)
+{
+  const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  __m128i v;
+  size_t i;
+
+  for (i=0; i+4<=n; i+=4)
+  {
+    v = _mm_loadu_si128((const __m128i *)(src + 4 * i));
+    _mm_storeu_si128((__m128i *)(dst + 4 * i), _mm_shuffle_epi8(v, mask));
+  }
+  swap_scalar(dst + 4 * i, src + 4 * i, n - i);
+}
+
+// Two 256-bit shuffles per iteration; pshufb works within each 128-bit
+// lane, so the mask is the SSSE3 one repeated
+__attribute__((target("avx2")))
+static void swap_avx2(uint8_t *dst, const uint8_t *src, size_t n)
+{
+  const __m256i mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  __m256i a, b;
+  size_t i;
+
+  for (i=0; i+16<=n; i+=16)
+  {
+    a = _mm256_loadu_si256((const __m256i *)(src + 4 * i));
+    b = _mm256_loadu_si256((const __m256i *)(src + 4 * i + 32));
+    _mm256_storeu_si256((__m256i *)(dst + 4 * i), _mm256_shuffle_epi8(a, mask));
+    _mm256_storeu_si256((__m256i *)(dst + 4 * i + 32), _mm256_shuffle_epi8(b, mask));
+  }
+  for (; i+8<=n; i+=8)
+  {
+    a = _mm256_loadu_si256((const __m256i *)(src + 4 * i));
+    _mm256_storeu_si256((__m256i *)(dst + 4 * i), _mm256_shuffle_epi8(a, mask));
+  }
+  swap_scalar(dst + 4 * i, src + 4 * i, n - i);
+}
+#endif
+
+static bool supported(enum column_codec codec)
+{
+#if defined(COLUMN_CODEC_X86) && !(defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  if (codec == COLUMN_CODEC_AVX2)
+    return __builtin_cpu_supports("avx2");
+  if (codec == COLUMN_CODEC_SSSE3)
+    return __builtin_cpu_supports("ssse3");
+#endif
+  return codec == COLUMN_CODEC_SCALAR;
+}
+
+static swap_fn implementation(enum column_codec codec)
+{
+#ifdef COLUMN_CODEC_X86
+  if (codec == COLUMN_CODEC_AVX2)
+    return swap_avx2;
+  if (codec == COLUMN_CODEC_SSSE3)
+    return swap_ssse3;
+#endif
+  return swap_scalar;
+}
+
+static enum column_codec best()
+{
+  if (supported(COLUMN_CODEC_AVX2))
+    return COLUMN_CODEC_AVX2;
+  if (supported(COLUMN_CODEC_SSSE3))
+    return COLUMN_CODEC_SSSE3;
+  return COLUMN_CODEC_SCALAR;
+}
+
+struct codec_choice
+{
+  enum column_codec codec;
+  swap_fn impl;
+};
+
+// Detected on first use (a thread-safe static, so the codec also works
+// from static initializers and from several threads at once)
+static const struct codec_choice &detected()
+{
+  static const struct codec_choice choice = { best(), implementation(best()) };
+  return choice;
+}
+
+// Set by column_codec_select(); NUM_OF_COLUMN_CODECS: the detected codec
+static std::atomic<int> forced(NUM_OF_COLUMN_CODECS);
+
+static inline swap_fn current()
+{
+  int codec = forced.load(std::memory_order_relaxed);
+
+  if (codec != NUM_OF_COLUMN_CODECS)
+    return implementation((enum column_codec)codec);
+  return detected().impl;
+}
+
+void encode_be_f32_column(void *dst, const float *src, size_t n)
+{
+  current()((uint8_t *)dst, (const uint8_t *)src, n);
+}
+
+void decode_be_f32_column(float *dst, const void *src, size_t n)
+{
+  current()((uint8_t *)dst, (const uint8_t *)src, n);
+}
+
+int column_codec_select(enum column_codec codec)
+{
+  if (codec >= NUM_OF_COLUMN_CODECS || !supported(codec))
+    return FAILURE;
+  forced.store(codec, std::memory_order_relaxed);
+  return SUCCESS;
+}
+
+enum column_codec column_codec_current()
+{
+  int codec = forced.load(std::memory_order_relaxed);
+
+  if (codec != NUM_OF_COLUMN_CODECS)
+    return (enum column_codec)codec;
+  return detected().codec;
+}
+
+const char *column_codec_name(enum column_codec codec)
+{
+  switch (codec)
+  {
+    case COLUMN_CODEC_SCALAR: return "scalar";
+    case COLUMN_CODEC_SSSE3: return "ssse3";
+    case COLUMN_CODEC_AVX2: return "avx2";
+    default: return "unknown";
+  }
+}
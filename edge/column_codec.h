@@ -0,0 +1,28 @@
+#ifndef __COLUMN_CODEC_H__
+#define __COLUMN_CODEC_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// Bulk conversion of float columns to and from big-endian bytes. The byte
+// swap runs 4 (SSSE3) or 8 (AVX2) words per pshufb; the implementation is
+// picked once from the CPU features, with a scalar fallback
+enum column_codec
+{
+  COLUMN_CODEC_SCALAR,
+  COLUMN_CODEC_SSSE3,
+  COLUMN_CODEC_AVX2,
+  NUM_OF_COLUMN_CODECS
+};
+
+// dst receives 4 * n bytes; dst == src is allowed
+void encode_be_f32_column(void *dst, const float *src, size_t n);
+void decode_be_f32_column(float *dst, const void *src, size_t n);
+
+// Forces an implementation (for benchmarks); returns FAILURE if the CPU
+// does not support it
+int column_codec_select(enum column_codec codec);
+enum column_codec column_codec_current();
+const char *column_codec_name(enum column_codec codec);
+
+#endif /* __COLUMN_CODEC_H__ */
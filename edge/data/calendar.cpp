@@ -0,0 +1,87 @@
+#include <cstdlib>
+#include "calendar.h"
+#include "../setting.h"
+
+static long startup_offset()
+{
+  time_t now;
+  struct tm tm;
+
+  now = time(NULL);
+  if (!localtime_r(&now, &tm))
+    return 0;
+  return tm.tm_gmtoff;
+}
+
+// Set once before the threads start; read-only afterwards
+static long utc_offset = startup_offset();
+
+void setUtcOffset(long seconds)
+{
+  utc_offset = seconds;
+}
+
+long getUtcOffset()
+{
+  return utc_offset;
+}
+
+static inline bool is_digit(char c)
+{
+  return (unsigned char)(c - '0') < 10;
+}
+
+// [+-]H[H][:MM], or unsigned seconds; at most 14 hours
+int parseUtcOffset(const char *s, long *seconds)
+{
+  int sign, hh, mm;
+  long v;
+  char *end;
+
+  if (s[0] != '+' && s[0] != '-')
+  {
+    if (!is_digit(s[0]))
+      return FAILURE;
+    v = strtol(s, &end, 10);
+    if (*end != 0 || v > 14 * 3600)
+      return FAILURE;
+    *seconds = v;
+    return SUCCESS;
+  }
+
+  sign = (s[0] == '-') ? -1 : 1;
+  s++;
+  if (!is_digit(s[0]))
+    return FAILURE;
+  hh = *s++ - '0';
+  if (is_digit(s[0]))
+    hh = hh * 10 + (*s++ - '0');
+
+  mm = 0;
+  if (s[0] == ':')
+  {
+    if (!is_digit(s[1]) || !is_digit(s[2]))
+      return FAILURE;
+    mm = (s[1] - '0') * 10 + (s[2] - '0');
+    s += 3;
+  }
+
+  if (s[0] != 0 || hh > 14 || mm > 59 || (hh == 14 && mm > 0))
+    return FAILURE;
+
+  *seconds = sign * (hh * 3600L + mm * 60L);
+  return SUCCESS;
+}
+
+long localDay(time_t timestamp)
+{
+  long t;
+
+  t = (long)timestamp + utc_offset;
+  return (t >= 0 ? t : t - 86399) / 86400;
+}
+
+struct civil_date localDate(time_t timestamp)
+{
+  return civil_from_days(localDay(timestamp));
+}
@@ -0,0 +1,58 @@
+#ifndef __CALENDAR_H__
+#define __CALENDAR_H__
+
+#include <ctime>
+
+// Calendar arithmetic on epoch seconds without localtime(): no global
+// lock and no TZ lookups, so it is safe to call from any thread.
+// Local time is UTC shifted by one fixed offset for the whole run
+
+struct civil_date
+{
+  int year;
+  int month;    // 1 - 12
+  int day;      // 1 - 31
+};
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+constexpr long days_from_civil(long y, int m, int d)
+{
+  y -= m <= 2;
+  long era = (y >= 0 ? y : y - 399) / 400;
+  long yoe = y - era * 400;
+  long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+// Inverse of days_from_civil()
+constexpr struct civil_date civil_from_days(long z)
+{
+  z += 719468;
+  long era = (z >= 0 ? z : z - 146096) / 146097;
+  long doe = z - era * 146097;
+  long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  long mp = (5 * doy + 2) / 153;
+  int d = doy - (153 * mp + 2) / 5 + 1;
+  int m = mp < 10 ? mp + 3 : mp - 9;
+  return { (int)(yoe + era * 400 + (m <= 2)), m, d };
+}
+
+static_assert(days_from_civil(2021, 1, 1) == 18628, "days_from_civil");
+static_assert(civil_from_days(18628).year == 2021 && civil_from_days(18628).day == 1, "civil_from_days");
+
+// Offset of local time from UTC in seconds; defaults to the offset of
+// the process time zone at startup (tm_gmtoff)
+void setUtcOffset(long seconds);
+long getUtcOffset();
+
+// Parses "+HH:MM", "-H", "+HH" or a number of seconds east of UTC
+// ("3600"), at most 14 hours either way; returns SUCCESS or FAILURE
+int parseUtcOffset(const char *s, long *seconds);
+
+// Local day number (days since 1970-01-01) and local date of a timestamp
+long localDay(time_t timestamp);
+struct civil_date localDate(time_t timestamp);
+
+#endif /* __CALENDAR_H__ */
@@ -0,0 +1,107 @@
+#include <cstring>
+#include "customer_directory.h"
+
+CustomerDirectory::CustomerDirectory()
+{
+}
+
+void CustomerDirectory::clear()
+{
+  this->entries.clear();
+  this->pool.clear();
+  this->interned.clear();
+}
+
+void CustomerDirectory::reserve(uint32_t num)
+{
+  this->entries.reserve(num);
+}
+
+uint32_t CustomerDirectory::intern(string_view s)
+{
+  uint32_t offset;
+  unordered_map<string_view, uint32_t>::iterator it;
+
+  it = this->interned.find(s);
+  if (it != this->interned.end())
+    return it->second;
+
+  offset = this->store(s);
+  this->interned.emplace(string_view(this->pool.data() + offset, s.size()), offset);
+  return offset;
+}
+
+// The pool was reallocated: every key views the old buffer. Only the key
+// lengths are read from them; the hashes are those of the same bytes
+void CustomerDirectory::rebase()
+{
+  unordered_map<string_view, uint32_t> moved;
+
+  moved.reserve(this->interned.size());
+  for (const auto &it : this->interned)
+    moved.emplace(string_view(this->pool.data() + it.second, it.first.size()), it.second);
+  this->interned.swap(moved);
+}
+
+uint32_t CustomerDirectory::add(string_view serial, string_view name, string_view address)
+{
+  struct customer_entry entry;
+
+  memset(entry.serial, 0, SERIAL_LEN);
+  memcpy(entry.serial, serial.data(), serial.size() < SERIAL_LEN ? serial.size() : SERIAL_LEN);
+  entry.name = this->intern(name);
+  entry.name_len = name.size();
+  entry.address = this->intern(address);
+  entry.address_len = address.size();
+
+  this->entries.push_back(entry);
+  return this->entries.size() - 1;
+}
+
+uint32_t CustomerDirectory::store(string_view s)
+{
+  uint32_t offset;
+  const char *old;
+
+  offset = this->pool.size();
+  old = this->pool.data();
+  this->pool.insert(this->pool.end(), s.begin(), s.end());
+  if (this->pool.data() != old && !this->interned.empty())
+    this->rebase();
+  return offset;
+}
+
+uint32_t CustomerDirectory::addEntry(const struct customer_entry *entry)
+{
+  this->entries.push_back(*entry);
+  return this->entries.size() - 1;
+}
+
+uint32_t CustomerDirectory::size()
+{
+  return this->entries.size();
+}
+
+string_view CustomerDirectory::getSerial(uint32_t index)
+{
+  const char *serial;
+
+  serial = this->entries[index].serial;
+  return string_view(serial, strnlen(serial, SERIAL_LEN));
+}
+
+string_view CustomerDirectory::getName(uint32_t index)
+{
+  struct customer_entry *entry;
+
+  entry = &this->entries[index];
+  return string_view(this->pool.data() + entry->name, entry->name_len);
+}
+
+string_view CustomerDirectory::getAddress(uint32_t index)
+{
+  struct customer_entry *entry;
+
+  entry = &this->entries[index];
+  return string_view(this->pool.data() + entry->address, entry->address_len);
+}
@@ -0,0 +1,56 @@
+#ifndef __CUSTOMER_DIRECTORY_H__
+#define __CUSTOMER_DIRECTORY_H__
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#define SERIAL_LEN 16
+
+// One customer: the serial is stored inline (fixed width, zero padded),
+// the name and the address are offsets into the shared string pool
+struct customer_entry
+{
+  char serial[SERIAL_LEN];
+  uint32_t name;
+  uint32_t address;
+  uint16_t name_len;
+  uint16_t address_len;
+};
+
+// Table of the customers of one DataReceiver, addressed by a 32-bit
+// customer index. Identical names and addresses are stored once in the pool
+class CustomerDirectory
+{
+  private:
+    vector<struct customer_entry> entries;
+    vector<char> pool;
+    // pooled string -> its offset; the keys view the pool itself, so
+    // nothing is copied, and they are re-pointed when the pool moves
+    unordered_map<string_view, uint32_t> interned;
+
+    uint32_t intern(string_view s);
+    void rebase();
+
+  public:
+    CustomerDirectory();
+
+    void clear();
+    void reserve(uint32_t num);
+    uint32_t add(string_view serial, string_view name, string_view address);
+
+    // Bulk building: store() appends to the pool without interning and
+    // addEntry() appends an entry whose offsets the caller resolved
+    uint32_t store(string_view s);
+    uint32_t addEntry(const struct customer_entry *entry);
+    uint32_t size();
+
+    string_view getSerial(uint32_t index);
+    string_view getName(uint32_t index);
+    string_view getAddress(uint32_t index);
+};
+
+#endif /* __CUSTOMER_DIRECTORY_H__ */
@@ -0,0 +1,121 @@
+#include <cstring>
+#include <vector>
+#include "customer_generator.h"
+#include "house_info.h"
+
+using namespace std;
+
+CustomerGenerator::CustomerGenerator(uint64_t seed)
+{
+  this->seed = seed;
+}
+
+// splitmix64 finaliser over (seed, index, stream): independent 64-bit
+// values for every customer without any sequential state
+uint64_t CustomerGenerator::random(uint32_t index, uint32_t stream)
+{
+  uint64_t z;
+
+  z = this->seed + (((uint64_t)index << 2) | stream) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+void CustomerGenerator::makeSerial(uint32_t index, char *serial)
+{
+  uint64_t r[2];
+  uint8_t bits;
+  uint32_t num;
+
+  r[0] = this->random(index, 0);
+  r[1] = this->random(index, 1);
+
+  // one byte per character: the low bit picks digit or letter
+  for (int i=0; i<11; i++)
+  {
+    bits = r[i / 8] >> ((i % 8) * 8);
+    if (!(bits & 1))
+      serial[i] = (bits >> 1) % 10 + '0';
+    else
+      serial[i] = (bits >> 1) % 26 + 'A';
+  }
+
+  num = index % 100000;
+  for (int i=15; i>=11; i--)
+  {
+    serial[i] = num % 10 + '0';
+    num /= 10;
+  }
+}
+
+int CustomerGenerator::makeNameIndex(uint32_t index)
+{
+  uint64_t r;
+
+  r = this->random(index, 2);
+  return (r % NUM_OF_FIRST) * NUM_OF_LAST + (r >> 32) % NUM_OF_LAST;
+}
+
+int CustomerGenerator::makeAddressNumber(uint32_t index)
+{
+  return this->random(index, 3) % ADDRESS_MAX + 1;
+}
+
+// Names and addresses are drawn from small tables, so each distinct string
+// is written to the pool once and later customers reuse its offset
+void CustomerGenerator::generate(CustomerDirectory *dir, uint32_t num)
+{
+  struct customer_entry entry;
+  vector<uint32_t> names(NUM_OF_FIRST * NUM_OF_LAST, UINT32_MAX);
+  vector<uint16_t> name_lens(NUM_OF_FIRST * NUM_OF_LAST, 0);
+  vector<uint32_t> addresses(ADDRESS_MAX + 1, UINT32_MAX);
+  vector<uint16_t> address_lens(ADDRESS_MAX + 1, 0);
+  char buf[64];
+  const char *f, *l;
+  int ni, ai, len, fl, ll, dl;
+  uint32_t start;
+
+  start = dir->size();
+  dir->reserve(start + num);
+
+  for (uint32_t i=0; i<num; i++)
+  {
+    this->makeSerial(start + i, entry.serial);
+
+    ni = this->makeNameIndex(start + i);
+    if (names[ni] == UINT32_MAX)
+    {
+      f = first[ni / NUM_OF_LAST];
+      l = last[ni % NUM_OF_LAST];
+      fl = strlen(f);
+      ll = strlen(l);
+      memcpy(buf, f, fl);
+      buf[fl] = ' ';
+      memcpy(buf + fl + 1, l, ll);
+      len = fl + 1 + ll;
+      names[ni] = dir->store(string_view(buf, len));
+      name_lens[ni] = len;
+    }
+    entry.name = names[ni];
+    entry.name_len = name_lens[ni];
+
+    ai = this->makeAddressNumber(start + i);
+    if (addresses[ai] == UINT32_MAX)
+    {
+      dl = 0;
+      for (int v=ai; v>0; v/=10)
+        dl++;
+      for (int k=dl-1, v=ai; k>=0; k--, v/=10)
+        buf[k] = v % 10 + '0';
+      len = dl + sizeof(ADDRESS_STREET) - 1;
+      memcpy(buf + dl, ADDRESS_STREET, sizeof(ADDRESS_STREET) - 1);
+      addresses[ai] = dir->store(string_view(buf, len));
+      address_lens[ai] = len;
+    }
+    entry.address = addresses[ai];
+    entry.address_len = address_lens[ai];
+
+    dir->addEntry(&entry);
+  }
+}
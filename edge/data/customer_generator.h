@@ -0,0 +1,32 @@
+#ifndef __CUSTOMER_GENERATOR_H__
+#define __CUSTOMER_GENERATOR_H__
+
+#include <cstdint>
+#include "customer_directory.h"
+
+#define ADDRESS_MAX 50000
+#define ADDRESS_STREET " Songwol-gil, Jongro-gu, Seoul"
+
+// Builds random customers from a single seed. Every customer is derived
+// from a counter-based generator (splitmix64 of seed and index), so the
+// result depends only on (seed, index): no global rand() state, no reseeding
+class CustomerGenerator
+{
+  private:
+    uint64_t seed;
+
+    uint64_t random(uint32_t index, uint32_t stream);
+
+  public:
+    CustomerGenerator(uint64_t seed);
+
+    // 11 random digits/letters followed by the 5-digit customer number
+    void makeSerial(uint32_t index, char *serial);
+    int makeNameIndex(uint32_t index);
+    int makeAddressNumber(uint32_t index);
+
+    // Appends 'num' customers to the directory in a single pass
+    void generate(CustomerDirectory *dir, uint32_t num);
+};
+
+#endif /* __CUSTOMER_GENERATOR_H__ */
@@ -6,9 +6,17 @@ DataSet::DataSet(time_t timestamp)
 {
   this->timestamp = timestamp;
   this->num = 0;
-  this->head = NULL;
-  this->tail = NULL;
   this->iterator = 0;
+  this->hours = 1;
+  this->power = NULL;
+  this->owned = false;
+  this->index = NULL;
+}
+
+DataSet::~DataSet()
+{
+  if (this->owned)
+    delete[] this->power;
 }
 
 int DataSet::getNumHouseData()
@@ -16,35 +24,28 @@ int DataSet::getNumHouseData()
   return this->num;
 }
 
-void DataSet::addHouseData(HouseData *data)
+// Only for DataSets that carry the power column without HouseData entries
+void DataSet::setNumHouseData(int num)
 {
-  HouseData *curr;
-
-  if (!this->head)
-    this->head = data;
+  this->num = num;
+}
 
-  curr = this->tail;
-  if (curr)
-    curr->setNext(data);
-  this->tail = data;
+void DataSet::reserveHouseData(int num)
+{
+  this->houses.reserve(num);
+}
 
+void DataSet::addHouseData(const HouseData &data)
+{
+  this->houses.push_back(data);
   this->num++;
 }
 
 HouseData *DataSet::getHouseData(int index)
 {
-  HouseData *ret;
-  ret = this->head;
-
-  if (index < this->num)
-  {
-    for (int i=0; i<index; i++)
-      ret = ret->getNext();
-  }
-  else
-    ret = NULL;
-
-  return ret;
+  if (index < 0 || index >= (int)this->houses.size())
+    return NULL;
+  return &this->houses[index];
 }
 
 void DataSet::setIterator()
@@ -61,27 +62,68 @@ HouseData *DataSet::getNextHouseData()
   return ret;
 }
 
-void DataSet::setTemperatureData(TemperatureData *temp)
+void DataSet::setSerialIndex(SerialIndex *index)
+{
+  this->index = index;
+}
+
+HouseData *DataSet::findHouseData(string_view serial)
+{
+  int64_t idx;
+
+  if (!this->index)
+    return NULL;
+  idx = this->index->find(serial);
+  if (idx < 0)
+    return NULL;
+  return this->getHouseData(idx);
+}
+
+CustomerDirectory *DataSet::getDirectory()
+{
+  return this->index ? this->index->getDirectory() : NULL;
+}
+
+void DataSet::setTemperatureData(const TemperatureData &temp)
 {
   this->temp = temp;
 }
 
 TemperatureData *DataSet::getTemperatureData()
 {
-  return this->temp;
+  return &this->temp;
 }
 
-void DataSet::setHumidityData(HumidityData *humid)
+void DataSet::setHumidityData(const HumidityData &humid)
 {
   this->humid = humid;
 }
 
 HumidityData *DataSet::getHumidityData()
 {
-  return this->humid;
+  return &this->humid;
 }
 
 time_t DataSet::getTimestamp()
 {
   return this->timestamp;
 }
+
+void DataSet::setPowerColumn(float *power, int hours, bool owned)
+{
+  if (this->owned)
+    delete[] this->power;
+  this->power = power;
+  this->hours = hours;
+  this->owned = owned;
+}
+
+float *DataSet::getPowerColumn()
+{
+  return this->power;
+}
+
+int DataSet::getNumHours()
+{
+  return this->hours;
+}
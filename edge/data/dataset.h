@@ -1,36 +1,58 @@
 #ifndef __DATASET_H__
 #define __DATASET_H__
 
+#include <vector>
 #include "house_data.h"
 #include "temperature_data.h"
 #include "humidity_data.h"
+#include "serial_index.h"
 
 class DataSet
 {
   private:
     time_t timestamp;
     int num;
-    TemperatureData *temp;
-    HumidityData *humid;
-    HouseData *head;
-    HouseData *tail;
+    TemperatureData temp;
+    HumidityData humid;
+    vector<HouseData> houses;
     int iterator;
+    int hours;
+    float *power;
+    bool owned;
+    SerialIndex *index;
   public:
     DataSet(time_t timestamp);
+    ~DataSet();
 
     int getNumHouseData();
-    void addHouseData(HouseData *data);
+    void setNumHouseData(int num);
+    void reserveHouseData(int num);
+    void addHouseData(const HouseData &data);
     HouseData *getHouseData(int index);
     void setIterator();
     HouseData *getNextHouseData();
 
-    void setTemperatureData(TemperatureData *temp);
+    // Lookup by meter serial through the index shared by all DataSets of
+    // a DataReceiver
+    void setSerialIndex(SerialIndex *index);
+    HouseData *findHouseData(string_view serial);
+    // Customers of the houses, or NULL without an index
+    CustomerDirectory *getDirectory();
+
+    void setTemperatureData(const TemperatureData &temp);
     TemperatureData *getTemperatureData();
 
-    void setHumidityData(HumidityData *humid);
+    void setHumidityData(const HumidityData &humid);
     HumidityData *getHumidityData();
 
     time_t getTimestamp();
+
+    // Power readings stored column-wise: house i's readings are at
+    // power[i * hours .. i * hours + hours - 1] (hours is 1 or 24).
+    // A column that is not owned (e.g., a mapped file) is never freed
+    void setPowerColumn(float *power, int hours, bool owned);
+    float *getPowerColumn();
+    int getNumHours();
 };
 
 #endif /* __DATASET_H__ */
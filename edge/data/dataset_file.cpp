@@ -0,0 +1,276 @@
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "dataset_file.h"
+#include "temperature_data.h"
+#include "humidity_data.h"
+#include "../setting.h"
+#include "../column_codec.h"
+#include "../logger.h"
+
+DataSetWriter::DataSetWriter()
+{
+  this->fp = NULL;
+  memset(&this->header, 0, sizeof(this->header));
+}
+
+DataSetWriter::~DataSetWriter()
+{
+  this->close();
+}
+
+int DataSetWriter::open(const char *path, bool portable)
+{
+  this->fp = fopen(path, "wb");
+  if (!this->fp)
+  {
+    LOG_ERROR("[*] Error: cannot create the recording file %s\n", path);
+    return FAILURE;
+  }
+
+  memset(&this->header, 0, sizeof(this->header));
+  this->header.magic = DATASET_FILE_MAGIC;
+  this->header.version = DATASET_FILE_VERSION;
+  this->header.offset = sizeof(this->header);
+  this->header.flags = portable ? DATASET_FILE_BIG_ENDIAN : 0;
+
+  // placeholder; the layout is filled in with the first day
+  if (fwrite(&this->header, sizeof(this->header), 1, this->fp) != 1)
+    return FAILURE;
+
+  return SUCCESS;
+}
+
+int DataSetWriter::writeHeader()
+{
+  if (fseek(this->fp, 0, SEEK_SET) != 0
+      || fwrite(&this->header, sizeof(this->header), 1, this->fp) != 1
+      || fseek(this->fp, 0, SEEK_END) != 0)
+    return FAILURE;
+  return SUCCESS;
+}
+
+// Appends one day record and flushes it, so a recording cut short (the
+// edge killed) still holds every day written before
+int DataSetWriter::write(DataSet *ds, int customers)
+{
+  TemperatureData *tdata;
+  HumidityData *hdata;
+  float weather[6];
+  size_t count;
+
+  if (!this->fp || !ds->getPowerColumn())
+    return FAILURE;
+  if (customers == 0)
+    customers = ds->getNumHouseData();
+
+  if (this->header.days == 0)
+  {
+    this->header.first = ds->getTimestamp();
+    this->header.customers = customers;
+    this->header.hours = ds->getNumHours();
+    this->header.record = sizeof(float) * (6 + (uint64_t)this->header.customers * this->header.hours);
+    if (this->writeHeader() == FAILURE)
+      return FAILURE;
+  }
+  else if (this->header.customers != (uint32_t)customers
+      || this->header.hours != (uint32_t)ds->getNumHours())
+  {
+    LOG_ERROR("[*] Error: the DataSet does not match the recording layout\n");
+    return FAILURE;
+  }
+
+  tdata = ds->getTemperatureData();
+  hdata = ds->getHumidityData();
+  weather[0] = tdata->getMin();
+  weather[1] = tdata->getMax();
+  weather[2] = tdata->getValue();
+  weather[3] = hdata->getMin();
+  weather[4] = hdata->getMax();
+  weather[5] = hdata->getValue();
+
+  count = (size_t)this->header.customers * this->header.hours;
+  if (this->header.flags & DATASET_FILE_BIG_ENDIAN)
+  {
+    encode_be_f32_column(weather, weather, 6);
+    this->scratch.resize(sizeof(float) * count);
+    encode_be_f32_column(this->scratch.data(), ds->getPowerColumn(), count);
+    if (fwrite(weather, sizeof(float), 6, this->fp) != 6
+        || fwrite(this->scratch.data(), sizeof(float), count, this->fp) != count)
+      return FAILURE;
+  }
+  else if (fwrite(weather, sizeof(float), 6, this->fp) != 6
+      || fwrite(ds->getPowerColumn(), sizeof(float), count, this->fp) != count)
+    return FAILURE;
+
+  if (fflush(this->fp) != 0)
+    return FAILURE;
+
+  this->header.last = ds->getTimestamp();
+  this->header.days++;
+
+  return SUCCESS;
+}
+
+int DataSetWriter::close()
+{
+  int ret;
+
+  if (!this->fp)
+    return SUCCESS;
+
+  ret = this->writeHeader();
+  if (fclose(this->fp) != 0)
+    ret = FAILURE;
+  this->fp = NULL;
+
+  return ret;
+}
+
+DataSetReader::DataSetReader()
+{
+  this->base = NULL;
+  this->size = 0;
+  this->header = NULL;
+  this->records = NULL;
+  this->days = 0;
+  this->last = 0;
+}
+
+DataSetReader::~DataSetReader()
+{
+  if (this->base)
+    munmap(this->base, this->size);
+}
+
+// Every region is checked against the file size; a recording that was
+// never closed (days == 0) is replayed up to its last complete day
+int DataSetReader::open(const char *path)
+{
+  int fd;
+  struct stat st;
+  void *base;
+  struct dataset_file_header *header;
+  uint64_t days;
+
+  fd = ::open(path, O_RDONLY);
+  if (fd < 0 || fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct dataset_file_header))
+  {
+    LOG_ERROR("[*] Error: cannot open the recording file %s\n", path);
+    if (fd >= 0)
+      ::close(fd);
+    return FAILURE;
+  }
+
+  base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED)
+  {
+    LOG_ERROR("[*] Error: cannot map the recording file %s\n", path);
+    return FAILURE;
+  }
+
+  header = (struct dataset_file_header *)base;
+  if (header->magic != DATASET_FILE_MAGIC
+      || header->version != DATASET_FILE_VERSION
+      || (header->hours != 1 && header->hours != 24)
+      || header->customers == 0 || header->customers > MAX_CUSTOMERS
+      || header->offset != sizeof(struct dataset_file_header)
+      || header->record != sizeof(float) * (6 + (uint64_t)header->customers * header->hours))
+  {
+    LOG_ERROR("[*] Error: %s is not a valid recording\n", path);
+    munmap(base, st.st_size);
+    return FAILURE;
+  }
+
+  days = (st.st_size - header->offset) / header->record;
+  if (header->days > days || days == 0)
+  {
+    LOG_ERROR("[*] Error: %s is truncated (%lu of %u days)\n", path, (unsigned long)days, header->days);
+    munmap(base, st.st_size);
+    return FAILURE;
+  }
+  if (header->days == 0)
+    LOG_WARN("[!] %s was not closed; replaying its %lu complete days\n", path, (unsigned long)days);
+  else
+    days = header->days;
+
+  madvise(base, st.st_size, MADV_SEQUENTIAL);
+
+  this->base = (uint8_t *)base;
+  this->size = st.st_size;
+  this->header = header;
+  this->records = this->base + header->offset;
+  this->days = days;
+  this->last = header->days ? header->last : header->first + (time_t)(days - 1) * DATASET_FILE_DAY;
+
+  return SUCCESS;
+}
+
+int DataSetReader::getNumOfDays()
+{
+  return this->days;
+}
+
+int DataSetReader::getNumOfCustomer()
+{
+  return this->header ? this->header->customers : 0;
+}
+
+int DataSetReader::getNumOfHours()
+{
+  return this->header ? this->header->hours : 0;
+}
+
+time_t DataSetReader::getFirstTimestamp()
+{
+  return this->header ? this->header->first : 0;
+}
+
+time_t DataSetReader::getLastTimestamp()
+{
+  return this->last;
+}
+
+DataSet *DataSetReader::getDataSet(time_t timestamp)
+{
+  DataSet *ret;
+  long day;
+  float *t, *h, *power, *column;
+  float tv[3], hv[3];
+  size_t count;
+
+  if (!this->header)
+    return NULL;
+
+  day = (timestamp - this->header->first) / DATASET_FILE_DAY;
+  day %= (long)this->days;
+  if (day < 0)
+    day += this->days;
+
+  count = (size_t)this->header->customers * this->header->hours;
+  t = (float *)(this->records + day * this->header->record);
+  h = t + 3;
+  power = t + 6;
+
+  ret = new DataSet(timestamp);
+  ret->setNumHouseData(this->header->customers);
+  if (this->header->flags & DATASET_FILE_BIG_ENDIAN)
+  {
+    decode_be_f32_column(tv, t, 3);
+    decode_be_f32_column(hv, h, 3);
+    t = tv;
+    h = hv;
+    column = new float[count];
+    decode_be_f32_column(column, power, count);
+    ret->setPowerColumn(column, this->header->hours, true);
+  }
+  else
+    ret->setPowerColumn(power, this->header->hours, false);
+  ret->setTemperatureData(TemperatureData(timestamp, t[0], t[1], t[2]));
+  ret->setHumidityData(HumidityData(timestamp, h[0], h[1], h[2]));
+
+  return ret;
+}
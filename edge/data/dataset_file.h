@@ -0,0 +1,93 @@
+#ifndef __DATASET_FILE_H__
+#define __DATASET_FILE_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include "dataset.h"
+
+using namespace std;
+
+#define DATASET_FILE_MAGIC 0x44534554  // "DSET"
+#define DATASET_FILE_VERSION 2
+#define DATASET_FILE_DAY 86400
+
+// flags
+#define DATASET_FILE_BIG_ENDIAN 0x1   // the float columns are big-endian
+
+// Binary columnar recording of consecutive daily DataSets (the header in
+// host byte order, the columns in host or, with DATASET_FILE_BIG_ENDIAN,
+// network byte order):
+//   header (64 bytes)
+//   one record per day:
+//     temp     float[3]    (min, max, avg)
+//     humid    float[3]    (min, max, avg)
+//     power    float[customers][hours]
+// The header is written with the first day and completed by close(); the
+// days of a recording that was never closed are counted from the file size
+struct dataset_file_header
+{
+  uint32_t magic;
+  uint32_t version;
+  int64_t first;            // timestamp of the first day
+  int64_t last;             // timestamp of the last day (0 until close())
+  uint32_t days;            // 0 until close()
+  uint32_t customers;
+  uint32_t hours;
+  uint32_t flags;
+  uint64_t offset;          // of the first record
+  uint64_t record;          // bytes per record
+  uint64_t reserved;
+};
+
+class DataSetWriter
+{
+  private:
+    FILE *fp;
+    struct dataset_file_header header;
+    vector<uint8_t> scratch;
+
+    int writeHeader();
+
+  public:
+    DataSetWriter();
+    ~DataSetWriter();
+
+    // A portable recording stores the columns big-endian
+    int open(const char *path, bool portable = false);
+    // 'customers': houses per recorded day when the DataSet's power column
+    // is wider than its houses (0: the DataSet's houses)
+    int write(DataSet *ds, int customers = 0);
+    int close();
+};
+
+class DataSetReader
+{
+  private:
+    uint8_t *base;
+    size_t size;
+    struct dataset_file_header *header;
+    uint8_t *records;
+    uint32_t days;
+    time_t last;
+
+  public:
+    DataSetReader();
+    ~DataSetReader();
+
+    int open(const char *path);
+
+    int getNumOfDays();
+    int getNumOfCustomer();
+    int getNumOfHours();
+    time_t getFirstTimestamp();
+    time_t getLastTimestamp();
+
+    // The returned DataSet borrows its power column from the mapping (no
+    // HouseData entries), or owns a converted copy for a portable
+    // recording; a timestamp past the recording wraps around
+    DataSet *getDataSet(time_t timestamp);
+};
+
+#endif /* __DATASET_FILE_H__ */
@@ -0,0 +1,242 @@
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "history_store.h"
+#include "../setting.h"
+#include "../logger.h"
+
+using namespace std;
+
+HistoryStore::HistoryStore(int capacity, int customers)
+{
+  this->capacity = capacity;
+  this->customers = customers;
+  this->size = sizeof(struct history_header)
+    + sizeof(int64_t) * capacity
+    + sizeof(float) * (size_t)capacity * customers;
+  this->base = NULL;
+  this->mapped = false;
+  this->header = NULL;
+  this->timestamps = NULL;
+  this->values = NULL;
+}
+
+HistoryStore::~HistoryStore()
+{
+  if (this->mapped)
+    munmap(this->base, this->size);
+  else
+    free(this->base);
+}
+
+void HistoryStore::setLayout(uint8_t *base)
+{
+  this->base = base;
+  this->header = (struct history_header *)base;
+  this->timestamps = (int64_t *)(base + sizeof(struct history_header));
+  this->values = (float *)(this->timestamps + this->capacity);
+}
+
+// Keeps the history in (anonymous) process memory
+int HistoryStore::init()
+{
+  uint8_t *base;
+
+  base = (uint8_t *)calloc(1, this->size);
+  if (!base)
+    return FAILURE;
+
+  this->setLayout(base);
+  this->header->magic = HISTORY_MAGIC;
+  this->header->version = HISTORY_VERSION;
+  this->header->capacity = this->capacity;
+  this->header->customers = this->customers;
+  this->header->count = 0;
+
+  return SUCCESS;
+}
+
+// Keeps the history in a shared mapping of 'path' so it survives restarts.
+// A new (empty) file is initialized; a file of another geometry is
+// refused rather than overwritten
+int HistoryStore::open(const char *path, uint64_t seed)
+{
+  int fd;
+  struct stat st;
+  struct history_header h;
+  void *base;
+  bool fresh;
+
+  fd = ::open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0 || fstat(fd, &st) < 0)
+  {
+    LOG_ERROR("[*] Error: cannot open the history file %s\n", path);
+    if (fd >= 0)
+      close(fd);
+    return FAILURE;
+  }
+
+  fresh = st.st_size == 0;
+  if (!fresh)
+  {
+    if (pread(fd, &h, sizeof(h), 0) != sizeof(h)
+        || h.magic != HISTORY_MAGIC || h.version != HISTORY_VERSION)
+    {
+      LOG_ERROR("[*] Error: %s is not a history file\n", path);
+      close(fd);
+      return FAILURE;
+    }
+    if (h.capacity != (uint32_t)this->capacity || h.customers != (uint32_t)this->customers
+        || (size_t)st.st_size != this->size)
+    {
+      LOG_ERROR("[*] Error: %s keeps %u days x %u customers, not %d x %d; use the same -d and -c, or remove the file\n",
+          path, h.capacity, h.customers, this->capacity, this->customers);
+      close(fd);
+      return FAILURE;
+    }
+  }
+  else if (ftruncate(fd, this->size) < 0)
+  {
+    LOG_ERROR("[*] Error: cannot resize the history file %s\n", path);
+    close(fd);
+    return FAILURE;
+  }
+
+  base = mmap(NULL, this->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+  {
+    LOG_ERROR("[*] Error: cannot map the history file %s\n", path);
+    return FAILURE;
+  }
+
+  this->setLayout((uint8_t *)base);
+  this->mapped = true;
+
+  if (fresh)
+  {
+    this->header->magic = HISTORY_MAGIC;
+    this->header->version = HISTORY_VERSION;
+    this->header->capacity = this->capacity;
+    this->header->customers = this->customers;
+    this->header->count = 0;
+    this->header->seed = seed;
+  }
+
+  return SUCCESS;
+}
+
+// Stores the daily consumption of every house in the next slot, overwriting
+// the oldest day once the ring is full; the houses the DataSet lacks get 0
+void HistoryStore::append(DataSet *ds)
+{
+  int slot, num, hours;
+  float *column, *row;
+  float daily;
+
+  slot = this->header->count % this->capacity;
+  num = ds->getNumHouseData();
+  if (num > this->customers)
+    num = this->customers;
+  hours = ds->getNumHours();
+  column = ds->getPowerColumn();
+
+  for (int i=0; i<num; i++)
+  {
+    row = column + i * hours;
+    daily = 0;
+    for (int h=0; h<hours; h++)
+      daily += row[h];
+    this->values[(size_t)i * this->capacity + slot] = daily;
+  }
+  for (int i=num; i<this->customers; i++)
+    this->values[(size_t)i * this->capacity + slot] = 0;
+
+  this->timestamps[slot] = ds->getTimestamp();
+  this->header->count++;
+}
+
+int HistoryStore::getCapacity()
+{
+  return this->capacity;
+}
+
+int HistoryStore::getNumOfCustomer()
+{
+  return this->customers;
+}
+
+int HistoryStore::getNumOfDays()
+{
+  if (this->header->count < (uint64_t)this->capacity)
+    return this->header->count;
+  return this->capacity;
+}
+
+uint64_t HistoryStore::getSeed()
+{
+  return this->header->seed;
+}
+
+int HistoryStore::getSlot(int age)
+{
+  if (age < 0 || age >= this->getNumOfDays())
+    return -1;
+  return (this->header->count - 1 - age) % this->capacity;
+}
+
+time_t HistoryStore::getTimestamp(int age)
+{
+  int slot;
+
+  slot = this->getSlot(age);
+  if (slot < 0)
+    return 0;
+  return this->timestamps[slot];
+}
+
+float HistoryStore::getValue(int house, int age)
+{
+  int slot;
+
+  slot = this->getSlot(age);
+  if (slot < 0 || house < 0 || house >= this->customers)
+    return 0;
+  return this->values[(size_t)house * this->capacity + slot];
+}
+
+float *HistoryStore::getHouseRing(int house)
+{
+  if (house < 0 || house >= this->customers)
+    return NULL;
+  return this->values + (size_t)house * this->capacity;
+}
+
+int HistoryStore::getHouseHistory(int house, float *out, int max)
+{
+  int days, first, tail;
+  float *ring;
+
+  ring = this->getHouseRing(house);
+  if (!ring)
+    return 0;
+
+  days = this->getNumOfDays();
+  if (max < days)
+    days = max;
+
+  // oldest requested day, then at most two contiguous runs of the ring
+  first = this->getSlot(days - 1);
+  if (first < 0)
+    return 0;
+  tail = this->capacity - first;
+  if (tail > days)
+    tail = days;
+  memcpy(out, ring + first, sizeof(float) * tail);
+  memcpy(out + tail, ring, sizeof(float) * (days - tail));
+
+  return days;
+}
@@ -0,0 +1,64 @@
+#ifndef __HISTORY_STORE_H__
+#define __HISTORY_STORE_H__
+
+#include <cstdint>
+#include <ctime>
+#include "dataset.h"
+
+#define HISTORY_MAGIC 0x48495354  // "HIST"
+#define HISTORY_VERSION 2
+
+// Layout of the store; the header, the timestamp ring and the value rings
+// live in one contiguous block (heap or mmap'd file):
+//   header | timestamps[capacity] | values[customers][capacity]
+struct history_header
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t capacity;
+  uint32_t customers;
+  uint64_t count;           // number of days ever appended
+  uint64_t seed;            // of the generated customers (file only)
+};
+
+class HistoryStore
+{
+  private:
+    int capacity;
+    int customers;
+    size_t size;
+    uint8_t *base;
+    bool mapped;
+    struct history_header *header;
+    int64_t *timestamps;
+    float *values;
+
+    void setLayout(uint8_t *base);
+
+  public:
+    HistoryStore(int capacity, int customers);
+    ~HistoryStore();
+
+    int init();
+    // A new file records 'seed'; an existing one keeps its own (getSeed())
+    int open(const char *path, uint64_t seed);
+
+    void append(DataSet *ds);
+
+    int getCapacity();
+    int getNumOfCustomer();
+    int getNumOfDays();
+    uint64_t getSeed();
+
+    // age 0 is the latest day, age 1 the day before, ...
+    int getSlot(int age);
+    time_t getTimestamp(int age);
+    float getValue(int house, int age);
+
+    // The ring of one house; index it with getSlot()
+    float *getHouseRing(int house);
+    // Copies up to 'max' days of one house, oldest first
+    int getHouseHistory(int house, float *out, int max);
+};
+
+#endif /* __HISTORY_STORE_H__ */
@@ -2,59 +2,53 @@
 #include <iostream>
 #include "house_data.h"
 
-HouseData::HouseData(Info *info)
+HouseData::HouseData()
 {
-  this->info = info;
-  this->data = NULL;
+  this->customer = 0;
 }
 
-HouseData::HouseData(Info *info, PowerData *power)
+HouseData::HouseData(uint32_t customer)
 {
-  this->info = info;
-  this->data = power;
+  this->customer = customer;
 }
 
-void HouseData::setInfo(Info *info)
+HouseData::HouseData(uint32_t customer, const PowerData &power)
 {
-  this->info = info;
+  this->customer = customer;
+  this->data = power;
 }
 
-Info *HouseData::getInfo()
+void HouseData::setCustomer(uint32_t customer)
 {
-  return this->info;
+  this->customer = customer;
 }
 
-string HouseData::getSerial()
+uint32_t HouseData::getCustomer()
 {
-  return this->info->getSerial();
+  return this->customer;
 }
 
-string HouseData::getName()
+string_view HouseData::getSerial(CustomerDirectory *directory)
 {
-  return this->info->getName();
+  return directory->getSerial(this->customer);
 }
 
-string HouseData::getAddress()
+string_view HouseData::getName(CustomerDirectory *directory)
 {
-  return this->info->getAddress();
+  return directory->getName(this->customer);
 }
 
-void HouseData::setPowerData(PowerData *power)
+string_view HouseData::getAddress(CustomerDirectory *directory)
 {
-  this->data = power;
+  return directory->getAddress(this->customer);
 }
 
-PowerData *HouseData::getPowerData()
+void HouseData::setPowerData(const PowerData &power)
 {
-  return this->data;
-}
-
-void HouseData::setNext(HouseData *data)
-{
-  this->next = data;
+  this->data = power;
 }
 
-HouseData *HouseData::getNext()
+PowerData *HouseData::getPowerData()
 {
-  return this->next;
+  return &this->data;
 }
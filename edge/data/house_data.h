@@ -1,34 +1,37 @@
 #ifndef __HOUSE_DATA_H__
 #define __HOUSE_DATA_H__
 
-#include <string>
+#include <cstdint>
+#include <string_view>
 #include <ctime>
+#include <type_traits>
 #include "power_data.h"
-#include "house_data.h"
-#include "info.h"
+#include "customer_directory.h"
 using namespace std;
 
 class HouseData 
 {
   private:
-    Info *info;
-    PowerData *data;
-    HouseData *next;
+    uint32_t customer;
+    PowerData data;
   public:
-    HouseData(Info *info);
-    HouseData(Info *info, PowerData *power);
-    void setInfo(Info *info);
-    Info *getInfo();
+    HouseData();
+    HouseData(uint32_t customer);
+    HouseData(uint32_t customer, const PowerData &power);
+    void setCustomer(uint32_t customer);
+    uint32_t getCustomer();
 
-    string getSerial();
-    string getName();
-    string getAddress();
+    // Views into the directory of the DataReceiver that produced the house
+    // (DataSet::getDirectory()); no copy is made
+    string_view getSerial(CustomerDirectory *directory);
+    string_view getName(CustomerDirectory *directory);
+    string_view getAddress(CustomerDirectory *directory);
 
-    void setPowerData(PowerData *power);
+    void setPowerData(const PowerData &power);
     PowerData *getPowerData();
-
-    void setNext(HouseData *hd);
-    HouseData *getNext();
 };
 
+// Plain value type: stored contiguously by value in DataSet
+static_assert(is_trivially_copyable<HouseData>::value, "HouseData must stay trivially copyable");
+
 #endif /* __HOUSE_DATA_H__ */
@@ -1,10 +1,8 @@
 #ifndef __HOUSE_INFO_H__
 #define __HOUSE_INFO_H__
 
-#include <string>
-using namespace std;
-
-const string first[] = {
+// plain character tables: no static constructors, usable from any generator
+const char *const first[] = {
   "Aiden", "Andew", "Adrian", "Asher", "Austin", "Ayaan", "Aaron", "Alex", "Andres", "Antonio", "Archer",
   "Benjamin", "Brandon", "Bentley", "Blake", "Brody", "Bennett", "Bradley", "Brooks", "Bruno",
   "Christopher", "Connor", "Charles", "Caleb", "Cooper", "Colin", "Corbin", "Covy", "Chico",
@@ -33,7 +31,7 @@ const string first[] = {
   "Zachary", "Zayden", "Zane", "Zion"
 };
 
-const string last[] = {
+const char *const last[] = {
   "Gordon", "Goodman", "Grant", "Greenwood", "Neville", "Nelson", "Knox", "Dike", "Dyke", "Thatcher", "Davis", 
   "Wright", "Riley", "Reilly", "Ryleigh", "Rylie", "Robert", "Robin", "Robinson", "Ross", "Lowell", "Roy",
   "Rogers", "Lewis", "Lee", "Lietz", "Lindberg", "Myers", "Martin", "Madison", "Maddison", "McIntosh", "MacIntosh", 
@@ -49,4 +47,8 @@ const string last[] = {
   "Fletcher", "Fisher", "Fitzgerald", "FitzGerald", "Phil", "Philip", "Harding", "Howard", "Harris", "Harrison",
   "Hancock", "Hughes", "Hurley", "Holmes", "White"
 };
+
+#define NUM_OF_FIRST (sizeof(first) / sizeof(first[0]))
+#define NUM_OF_LAST (sizeof(last) / sizeof(last[0]))
+
 #endif /* __HOUSE_INFO_H__ */
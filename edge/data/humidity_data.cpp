@@ -1,23 +1,21 @@
 #include "humidity_data.h"
 
+HumidityData::HumidityData()
+{
+  this->timestamp = 0;
+  this->avg = 0;
+  this->min = 0;
+  this->max = 0;
+  this->unit = UNIT_PERCENT;
+}
+
 HumidityData::HumidityData(time_t timestamp, double min, double max, double avg)
 {
   this->timestamp = timestamp;
   this->avg = avg;
   this->min = min;
   this->max = max;
-  this->next = NULL;
-  this->unit = "\%";
-}
-
-void HumidityData::setNext(HumidityData *next)
-{
-  this->next = next;
-}
-
-HumidityData *HumidityData::getNext()
-{
-  return this->next;
+  this->unit = UNIT_PERCENT;
 }
 
 void HumidityData::setValue(double value)
@@ -60,7 +58,7 @@ time_t HumidityData::getTimestamp()
   return this->timestamp;
 }
 
-string HumidityData::getUnit()
+enum unit HumidityData::getUnit()
 {
   return this->unit;
 }
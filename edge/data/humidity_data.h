@@ -1,10 +1,9 @@
 #ifndef __HUMIDITY_DATA_H__
 #define __HUMIDITY_DATA_H__
 
-#include <random>
 #include <ctime>
-#include <string>
-#include "info.h"
+#include <type_traits>
+#include "unit.h"
 
 class HumidityData
 {
@@ -13,14 +12,11 @@ class HumidityData
     double avg;
     double min;
     double max;
-    string unit;
-    HumidityData *next;
+    enum unit unit;
   public:
+    HumidityData();
     HumidityData(time_t timestamp, double min, double max, double avg);
 
-    void setNext(HumidityData *data);
-    HumidityData *getNext();
-
     void setValue(double value);
     double getValue();
 
@@ -33,7 +29,10 @@ class HumidityData
     void setTimestamp(time_t timestamp);
     time_t getTimestamp();
 
-    string getUnit();
+    enum unit getUnit();
 };
 
+// Plain value type: lives by value in DataSet and can be memcpy'd
+static_assert(std::is_trivially_copyable<HumidityData>::value, "HumidityData must stay trivially copyable");
+
 #endif /* __HUMIDITY_DATA_H__ */
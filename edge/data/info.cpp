@@ -1,10 +1,8 @@
 #include "info.h"
 #include "house_info.h"
+#include "customer_generator.h"
 #include <string>
-#include <sstream>
-#include <ctime>
-#include <cstdlib>
-#include <iomanip>
+#include <random>
 using namespace std;
 
 Info::Info(int num)
@@ -31,30 +29,19 @@ string Info::getSerial()
   return this->serial;
 }
 
-string Info::generateRandomSerial(int num)
+// Customers built one at a time share a per-process seed
+static CustomerGenerator *generator()
 {
-  int coin, v;
-  stringstream ss;
-  string ret;
-  int seed;
-
-  seed = time(NULL) + 8 * num;
-  srand(seed);
-  ret = "";
+  static CustomerGenerator gen(((uint64_t)random_device()() << 32) | random_device()());
+  return &gen;
+}
 
-  for (int i=0; i<11; i++)
-  {
-    coin = rand() % 2;
-    if (!coin)
-      v = rand() % 10 + '0';
-    else
-      v = rand() % 26 + 'A';
-    ret += v;
-  }
-  ss << setw(5) << setfill('0') << num;
-  ret += ss.str();
+string Info::generateRandomSerial(int num)
+{
+  char serial[SERIAL_LEN];
 
-  return ret;
+  generator()->makeSerial(num, serial);
+  return string(serial, SERIAL_LEN);
 }
 
 void Info::setName(string name)
@@ -69,21 +56,10 @@ string Info::getName()
 
 string Info::generateRandomName(int num)
 {
-  string ret;
-  int count_first, count_last, first_index, last_index;
-  int seed;
-    
-  seed = time(NULL) + 7 * num;
-  srand(seed);
-  count_first = sizeof(first)/sizeof(string);
-  count_last = sizeof(last)/sizeof(string);
+  int index;
 
-  first_index = rand() % count_first;
-  last_index = rand() % count_last;
-
-  ret = first[first_index] + " " + last[last_index];
-
-  return ret;
+  index = generator()->makeNameIndex(num);
+  return string(first[index / NUM_OF_LAST]) + " " + last[index % NUM_OF_LAST];
 }
 
 void Info::setAddress(string address)
@@ -98,16 +74,5 @@ string Info::getAddress()
 
 string Info::generateRandomAddress(int num)
 {
-  string ret;
-  int addr, count;
-  int seed;
-
-  seed = time(NULL) + 9 * num;
-  srand(seed);
-
-  addr = rand() % 50000 + 1;
-  ret += to_string(addr) + " ";
-  ret += "Songwol-gil, Jongro-gu, Seoul";
-
-  return ret;
+  return to_string(generator()->makeAddressNumber(num)) + ADDRESS_STREET;
 }
@@ -0,0 +1,224 @@
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "meter_csv.h"
+#include "calendar.h"
+#include "../setting.h"
+#include "../logger.h"
+
+using namespace std;
+
+static inline bool is_digit(char c)
+{
+  return (unsigned char)(c - '0') < 10;
+}
+
+// Parses up to 'max' digits; returns the number of digits consumed
+static inline int parse_digits(const char *p, const char *end, int max, long *v)
+{
+  int n;
+
+  *v = 0;
+  for (n = 0; n < max && p + n < end && is_digit(p[n]); n++)
+    *v = *v * 10 + (p[n] - '0');
+  return n;
+}
+
+MeterCsvReader::MeterCsvReader()
+{
+  this->fd = -1;
+  this->buf = NULL;
+  this->len = 0;
+  this->pos = 0;
+  this->eof = false;
+  this->line = 0;
+  this->errors = 0;
+}
+
+MeterCsvReader::~MeterCsvReader()
+{
+  if (this->fd >= 0)
+    close(this->fd);
+  free(this->buf);
+}
+
+int MeterCsvReader::open(const char *path)
+{
+  this->fd = ::open(path, O_RDONLY);
+  if (this->fd < 0)
+  {
+    LOG_ERROR("[*] Error: cannot open the meter file %s\n", path);
+    return FAILURE;
+  }
+  posix_fadvise(this->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  this->buf = (char *)malloc(METER_CHUNK);
+  this->len = 0;
+  this->pos = 0;
+  this->eof = false;
+  this->line = 0;
+  this->errors = 0;
+
+  return SUCCESS;
+}
+
+// Moves the unparsed tail to the front and reads the next chunk behind it
+bool MeterCsvReader::fill()
+{
+  ssize_t n;
+
+  if (this->eof)
+    return false;
+
+  // a line longer than a chunk cannot be a meter record; drop it
+  if (this->pos == 0 && this->len == METER_CHUNK)
+  {
+    this->len = 0;
+    this->errors++;
+  }
+
+  memmove(this->buf, this->buf + this->pos, this->len - this->pos);
+  this->len -= this->pos;
+  this->pos = 0;
+
+  n = read(this->fd, this->buf + this->len, METER_CHUNK - this->len);
+  if (n <= 0)
+  {
+    this->eof = true;
+    return false;
+  }
+  this->len += n;
+  return true;
+}
+
+bool MeterCsvReader::parseLine(const char *p, const char *end, struct meter_record *rec)
+{
+  long y, mo, d, hh, mi, ss, v;
+  int n;
+  const char *s;
+  double kwh, scale;
+  bool neg;
+
+  // timestamp: epoch seconds or YYYY-MM-DD[ T]HH:MM[:SS]; 18 digits always
+  // fit a long, longer numbers are malformed
+  n = parse_digits(p, end, 18, &v);
+  if (n == 0 || (p + n < end && is_digit(p[n])))
+    return false;
+  if (n == 4 && p + n < end && p[n] == '-')
+  {
+    y = v;
+    p += 5;
+    if (p >= end || parse_digits(p, end, 2, &mo) != 2 || p + 2 >= end || p[2] != '-')
+      return false;
+    p += 3;
+    if (parse_digits(p, end, 2, &d) != 2)
+      return false;
+    p += 2;
+    hh = mi = ss = 0;
+    if (p < end && (*p == ' ' || *p == 'T'))
+    {
+      p++;
+      if (parse_digits(p, end, 2, &hh) != 2 || p + 2 >= end || p[2] != ':')
+        return false;
+      p += 3;
+      if (parse_digits(p, end, 2, &mi) != 2)
+        return false;
+      p += 2;
+      if (p < end && *p == ':')
+      {
+        p++;
+        if (parse_digits(p, end, 2, &ss) != 2)
+          return false;
+        p += 2;
+      }
+    }
+    rec->timestamp = days_from_civil(y, mo, d) * 86400 + hh * 3600 + mi * 60 + ss;
+  }
+  else
+  {
+    rec->timestamp = v;
+    p += n;
+  }
+  if (p >= end || *p != ',')
+    return false;
+  p++;
+
+  // serial
+  s = (const char *)memchr(p, ',', end - p);
+  if (!s || s == p || s - p > METER_SERIAL_LEN)
+    return false;
+  rec->serial_len = s - p;
+  memcpy(rec->serial, p, rec->serial_len);
+  rec->serial[rec->serial_len] = 0;
+  p = s + 1;
+
+  // kWh: [-]digits[.digits]
+  neg = (p < end && *p == '-');
+  if (neg)
+    p++;
+  kwh = 0;
+  n = 0;
+  for (; p < end && is_digit(*p); p++, n++)
+    kwh = kwh * 10 + (*p - '0');
+  if (p < end && *p == '.')
+  {
+    scale = 0.1;
+    for (p++; p < end && is_digit(*p); p++, n++, scale *= 0.1)
+      kwh += (*p - '0') * scale;
+  }
+  if (n == 0)
+    return false;
+  rec->kwh = neg ? -kwh : kwh;
+
+  return true;
+}
+
+// Returns the next well-formed record; the header line and malformed lines
+// are skipped (and counted)
+int MeterCsvReader::next(struct meter_record *rec)
+{
+  char *p, *nl, *end;
+
+  if (this->fd < 0)
+    return FAILURE;
+
+  while (1)
+  {
+    p = this->buf + this->pos;
+    nl = (char *)memchr(p, '\n', this->len - this->pos);
+    if (!nl)
+    {
+      if (this->fill())
+        continue;
+      // the last line may have no newline
+      if (this->pos == this->len)
+        return FAILURE;
+      p = this->buf + this->pos;
+      nl = this->buf + this->len;
+    }
+
+    end = nl;
+    if (end > p && end[-1] == '\r')
+      end--;
+    this->pos = (nl - this->buf) + (nl < this->buf + this->len ? 1 : 0);
+    this->line++;
+
+    if (end == p)
+      continue;
+    if (this->parseLine(p, end, rec))
+      return SUCCESS;
+    if (this->line > 1 || is_digit(*p))
+      this->errors++;
+  }
+}
+
+long MeterCsvReader::getNumOfLines()
+{
+  return this->line;
+}
+
+long MeterCsvReader::getNumOfErrors()
+{
+  return this->errors;
+}
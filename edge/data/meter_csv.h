@@ -0,0 +1,47 @@
+#ifndef __METER_CSV_H__
+#define __METER_CSV_H__
+
+#include <cstddef>
+#include <ctime>
+
+#define METER_SERIAL_LEN 16
+#define METER_CHUNK (1 << 20)
+
+// One row of a smart-meter export: "timestamp,serial,kWh"; the timestamp
+// is either epoch seconds or "YYYY-MM-DD HH:MM[:SS]" (UTC)
+struct meter_record
+{
+  time_t timestamp;
+  char serial[METER_SERIAL_LEN + 1];
+  int serial_len;
+  double kwh;
+};
+
+// Streams a CSV export in fixed-size chunks; lines are split with memchr
+// and the fields are parsed in place without allocation
+class MeterCsvReader
+{
+  private:
+    int fd;
+    char *buf;
+    size_t len;
+    size_t pos;
+    bool eof;
+    long line;
+    long errors;
+
+    bool fill();
+    bool parseLine(const char *p, const char *end, struct meter_record *rec);
+
+  public:
+    MeterCsvReader();
+    ~MeterCsvReader();
+
+    int open(const char *path);
+    int next(struct meter_record *rec);
+
+    long getNumOfLines();
+    long getNumOfErrors();
+};
+
+#endif /* __METER_CSV_H__ */
@@ -1,21 +1,17 @@
 #include "power_data.h"
 
-PowerData::PowerData(time_t timestamp, double avg)
-{
-  this->timestamp = timestamp;
-  this->avg = avg;
-  this->next = NULL;
-  this->unit = "kWh";
-}
-
-void PowerData::setNext(PowerData *next)
+PowerData::PowerData()
 {
-  this->next = next;
+  this->timestamp = 0;
+  this->avg = 0;
+  this->unit = UNIT_KWH;
 }
 
-PowerData *PowerData::getNext()
+PowerData::PowerData(time_t timestamp, double avg)
 {
-  return this->next;
+  this->timestamp = timestamp;
+  this->avg = avg;
+  this->unit = UNIT_KWH;
 }
 
 void PowerData::setValue(double value)
@@ -38,3 +34,7 @@ time_t PowerData::getTimestamp()
   return this->timestamp;
 }
 
+enum unit PowerData::getUnit()
+{
+  return this->unit;
+}
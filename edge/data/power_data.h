@@ -1,31 +1,30 @@
 #ifndef __POWER_DATA_H__
 #define __POWER_DATA_H__
 
-#include <random>
 #include <ctime>
-#include <string>
-#include "info.h"
+#include <type_traits>
+#include "unit.h"
 
 class PowerData
 {
   private:
     time_t timestamp;
     double avg;
-    string unit;
-    PowerData *next;
+    enum unit unit;
   public:
+    PowerData();
     PowerData(time_t timestamp, double avg);
 
-    void setNext(PowerData *data);
-    PowerData *getNext();
-
     void setValue(double value);
     double getValue();
 
     void setTimestamp(time_t timestamp);
     time_t getTimestamp();
 
-    string getUnit();
+    enum unit getUnit();
 };
 
+// Plain value type: lives by value in HouseData and can be memcpy'd
+static_assert(std::is_trivially_copyable<PowerData>::value, "PowerData must stay trivially copyable");
+
 #endif /* __POWER_DATA_H__ */
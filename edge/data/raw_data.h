@@ -1,17 +1,40 @@
 #ifndef __RAW_DATA_H__
 #define __RAW_DATA_H__
 
-#include <string>
-using namespace std;
+#include "calendar.h"
+
+// Reference data for the synthetic edge: two years (2021-2022) of daily
+// weather and monthly power means. The tables and accessors are constexpr
+// and inline, so a lookup compiles to a load (or to a constant)
+
+#define RAW_DATA_FIRST_YEAR 2021
+#define RAW_DATA_DAYS 730
+#define RAW_DATA_MONTHS 24
+
+struct weather
+{
+  double temp_min;
+  double temp_max;
+  double temp_avg;
+  double humid_min;
+  double humid_max;
+  double humid_avg;
+};
 
 // monthly mean values (power)
-int power_avg[] = {
+inline constexpr int raw_power_avg[RAW_DATA_MONTHS] = {
   239, 224, 189, 189, 179, 192, 243, 317, 224, 190, 189, 202,
   219, 223, 197, 193, 174, 187, 248, 290, 226, 185, 184, 202
 };
 
+// share of the daily consumption per hour of day (power, sums to 1.0)
+inline constexpr double raw_hour_profile[24] = {
+  0.030, 0.026, 0.024, 0.023, 0.023, 0.026, 0.035, 0.045, 0.048, 0.040, 0.037, 0.037,
+  0.040, 0.039, 0.038, 0.039, 0.042, 0.050, 0.065, 0.070, 0.068, 0.062, 0.053, 0.040
+};
+
 // daily mean values (temperature)
-double temp_avg[] = {
+inline constexpr double raw_temp_avg[RAW_DATA_DAYS] = {
   -4.45, -4.79, -5.59, -3.67, -4.96, -7.25, -14.06, -14.9, -12.25, -7.89,
   -6.76, -4.29, 1.84, 1.64, 4.78, -4.48, -5.9, -3.27, -6.44, -0.48,
   4.4, 5.53, 7.64, 7.47, 7.92, 5.7, 1.88, -1.89, -8.77, -1.71,
@@ -88,7 +111,7 @@ double temp_avg[] = {
 };
 
 // daily max values (temperature)
-double temp_max[] = {
+inline constexpr double raw_temp_max[RAW_DATA_DAYS] = {
   1.4, -1.5, -2.3, 0.2, -2.5, -2.2, -9.6, -11.2, -7.7, -2.8,
   -4.1, -0.7, 8.2, 6.8, 9.8, -1.7, -1.6, -0.2, -0.4, 7.1,
   6.9, 6.6, 11.9, 13.8, 13.7, 7.1, 6.5, 0.9, -5.0, 4.9,
@@ -165,7 +188,7 @@ double temp_max[] = {
 };
 
 // daily min values (temperature)
-double temp_min[] = {
+inline constexpr double raw_temp_min[RAW_DATA_DAYS] = {
   -9.7, -8.3, -9.0, -8.3, -9.5, -11.9, -16.4, -18.5, -16.4, -12.7,
   -9.5, -9.3, -3.0, -3.4, 0.2, -8.2, -10.8, -8.4, -11.6, -6.4,
   2.7, 4.9, 5.2, 2.4, 3.0, 2.4, -1.8, -8.9, -11.6, -6.9,
@@ -242,7 +265,7 @@ double temp_min[] = {
 };
 
 // daily mean values (humidity)
-double humid_avg[] = {
+inline constexpr double raw_humid_avg[RAW_DATA_DAYS] = {
   64.87, 38.43, 44.39, 48.91, 53.43, 53.87, 50.3, 44.3, 44.91, 53.57,
   62.22, 77.57, 82.78, 47.61, 65.57, 58.91, 55.65, 66.57, 38.43, 38.35,
   59.87, 93.17, 67.17, 62.91, 61.78, 79.61, 48.83, 53.65, 39.43, 58.22,
@@ -319,7 +342,7 @@ double humid_avg[] = {
 };
 
 // daily max values (humidity)
-int humid_max[] = {
+inline constexpr int raw_humid_max[RAW_DATA_DAYS] = {
   75, 50, 58, 69, 82, 89, 75, 55, 56, 69,
   72, 93, 95, 70, 82, 78, 86, 90, 54, 54,
   96, 97, 92, 79, 83, 95, 85, 93, 49, 80,
@@ -396,7 +419,7 @@ int humid_max[] = {
 };
 
 // daily min values (humidity)
-int humid_min[] = {
+inline constexpr int raw_humid_min[RAW_DATA_DAYS] = {
   52, 31, 30, 40, 31, 25, 37, 35, 37, 38,
   51, 61, 65, 29, 43, 39, 32, 34, 20, 24,
   37, 90, 50, 45, 37, 65, 21, 38, 31, 41,
@@ -472,87 +495,52 @@ int humid_min[] = {
   45, 53, 40, 47, 46, 51, 40, 34, 38, 59
 };
 
-// index
-const char *date[] = {
-  "2021-01-01", "2021-01-02", "2021-01-03", "2021-01-04", "2021-01-05", "2021-01-06", "2021-01-07", "2021-01-08", "2021-01-09", "2021-01-10",
-  "2021-01-11", "2021-01-12", "2021-01-13", "2021-01-14", "2021-01-15", "2021-01-16", "2021-01-17", "2021-01-18", "2021-01-19", "2021-01-20",
-  "2021-01-21", "2021-01-22", "2021-01-23", "2021-01-24", "2021-01-25", "2021-01-26", "2021-01-27", "2021-01-28", "2021-01-29", "2021-01-30",
-  "2021-01-31", "2021-02-01", "2021-02-02", "2021-02-03", "2021-02-04", "2021-02-05", "2021-02-06", "2021-02-07", "2021-02-08", "2021-02-09",
-  "2021-02-10", "2021-02-11", "2021-02-12", "2021-02-13", "2021-02-14", "2021-02-15", "2021-02-16", "2021-02-17", "2021-02-18", "2021-02-19",
-  "2021-02-20", "2021-02-21", "2021-02-22", "2021-02-23", "2021-02-24", "2021-02-25", "2021-02-26", "2021-02-27", "2021-02-28", "2021-03-01",
-  "2021-03-02", "2021-03-03", "2021-03-04", "2021-03-05", "2021-03-06", "2021-03-07", "2021-03-08", "2021-03-09", "2021-03-10", "2021-03-11",
-  "2021-03-12", "2021-03-13", "2021-03-14", "2021-03-15", "2021-03-16", "2021-03-17", "2021-03-18", "2021-03-19", "2021-03-20", "2021-03-21",
-  "2021-03-22", "2021-03-23", "2021-03-24", "2021-03-25", "2021-03-26", "2021-03-27", "2021-03-28", "2021-03-29", "2021-03-30", "2021-03-31",
-  "2021-04-01", "2021-04-02", "2021-04-03", "2021-04-04", "2021-04-05", "2021-04-06", "2021-04-07", "2021-04-08", "2021-04-09", "2021-04-10",
-  "2021-04-11", "2021-04-12", "2021-04-13", "2021-04-14", "2021-04-15", "2021-04-16", "2021-04-17", "2021-04-18", "2021-04-19", "2021-04-20",
-  "2021-04-21", "2021-04-22", "2021-04-23", "2021-04-24", "2021-04-25", "2021-04-26", "2021-04-27", "2021-04-28", "2021-04-29", "2021-04-30",
-  "2021-05-01", "2021-05-02", "2021-05-03", "2021-05-04", "2021-05-05", "2021-05-06", "2021-05-07", "2021-05-08", "2021-05-09", "2021-05-10",
-  "2021-05-11", "2021-05-12", "2021-05-13", "2021-05-14", "2021-05-15", "2021-05-16", "2021-05-17", "2021-05-18", "2021-05-19", "2021-05-20",
-  "2021-05-21", "2021-05-22", "2021-05-23", "2021-05-24", "2021-05-25", "2021-05-26", "2021-05-27", "2021-05-28", "2021-05-29", "2021-05-30",
-  "2021-05-31", "2021-06-01", "2021-06-02", "2021-06-03", "2021-06-04", "2021-06-05", "2021-06-06", "2021-06-07", "2021-06-08", "2021-06-09",
-  "2021-06-10", "2021-06-11", "2021-06-12", "2021-06-13", "2021-06-14", "2021-06-15", "2021-06-16", "2021-06-17", "2021-06-18", "2021-06-19",
-  "2021-06-20", "2021-06-21", "2021-06-22", "2021-06-23", "2021-06-24", "2021-06-25", "2021-06-26", "2021-06-27", "2021-06-28", "2021-06-29",
-  "2021-06-30", "2021-07-01", "2021-07-02", "2021-07-03", "2021-07-04", "2021-07-05", "2021-07-06", "2021-07-07", "2021-07-08", "2021-07-09",
-  "2021-07-10", "2021-07-11", "2021-07-12", "2021-07-13", "2021-07-14", "2021-07-15", "2021-07-16", "2021-07-17", "2021-07-18", "2021-07-19",
-  "2021-07-20", "2021-07-21", "2021-07-22", "2021-07-23", "2021-07-24", "2021-07-25", "2021-07-26", "2021-07-27", "2021-07-28", "2021-07-29",
-  "2021-07-30", "2021-07-31", "2021-08-01", "2021-08-02", "2021-08-03", "2021-08-04", "2021-08-05", "2021-08-06", "2021-08-07", "2021-08-08",
-  "2021-08-09", "2021-08-10", "2021-08-11", "2021-08-12", "2021-08-13", "2021-08-14", "2021-08-15", "2021-08-16", "2021-08-17", "2021-08-18",
-  "2021-08-19", "2021-08-20", "2021-08-21", "2021-08-22", "2021-08-23", "2021-08-24", "2021-08-25", "2021-08-26", "2021-08-27", "2021-08-28",
-  "2021-08-29", "2021-08-30", "2021-08-31", "2021-09-01", "2021-09-02", "2021-09-03", "2021-09-04", "2021-09-05", "2021-09-06", "2021-09-07",
-  "2021-09-08", "2021-09-09", "2021-09-10", "2021-09-11", "2021-09-12", "2021-09-13", "2021-09-14", "2021-09-15", "2021-09-16", "2021-09-17",
-  "2021-09-18", "2021-09-19", "2021-09-20", "2021-09-21", "2021-09-22", "2021-09-23", "2021-09-24", "2021-09-25", "2021-09-26", "2021-09-27",
-  "2021-09-28", "2021-09-29", "2021-09-30", "2021-10-01", "2021-10-02", "2021-10-03", "2021-10-04", "2021-10-05", "2021-10-06", "2021-10-07",
-  "2021-10-08", "2021-10-09", "2021-10-10", "2021-10-11", "2021-10-12", "2021-10-13", "2021-10-14", "2021-10-15", "2021-10-16", "2021-10-17",
-  "2021-10-18", "2021-10-19", "2021-10-20", "2021-10-21", "2021-10-22", "2021-10-23", "2021-10-24", "2021-10-25", "2021-10-26", "2021-10-27",
-  "2021-10-28", "2021-10-29", "2021-10-30", "2021-10-31", "2021-11-01", "2021-11-02", "2021-11-03", "2021-11-04", "2021-11-05", "2021-11-06",
-  "2021-11-07", "2021-11-08", "2021-11-09", "2021-11-10", "2021-11-11", "2021-11-12", "2021-11-13", "2021-11-14", "2021-11-15", "2021-11-16",
-  "2021-11-17", "2021-11-18", "2021-11-19", "2021-11-20", "2021-11-21", "2021-11-22", "2021-11-23", "2021-11-24", "2021-11-25", "2021-11-26",
-  "2021-11-27", "2021-11-28", "2021-11-29", "2021-11-30", "2021-12-01", "2021-12-02", "2021-12-03", "2021-12-04", "2021-12-05", "2021-12-06",
-  "2021-12-07", "2021-12-08", "2021-12-09", "2021-12-10", "2021-12-11", "2021-12-12", "2021-12-13", "2021-12-14", "2021-12-15", "2021-12-16",
-  "2021-12-17", "2021-12-18", "2021-12-19", "2021-12-20", "2021-12-21", "2021-12-22", "2021-12-23", "2021-12-24", "2021-12-25", "2021-12-26",
-  "2021-12-27", "2021-12-28", "2021-12-29", "2021-12-30", "2021-12-31", "2022-01-01", "2022-01-02", "2022-01-03", "2022-01-04", "2022-01-05",
-  "2022-01-06", "2022-01-07", "2022-01-08", "2022-01-09", "2022-01-10", "2022-01-11", "2022-01-12", "2022-01-13", "2022-01-14", "2022-01-15",
-  "2022-01-16", "2022-01-17", "2022-01-18", "2022-01-19", "2022-01-20", "2022-01-21", "2022-01-22", "2022-01-23", "2022-01-24", "2022-01-25",
-  "2022-01-26", "2022-01-27", "2022-01-28", "2022-01-29", "2022-01-30", "2022-01-31", "2022-02-01", "2022-02-02", "2022-02-03", "2022-02-04",
-  "2022-02-05", "2022-02-06", "2022-02-07", "2022-02-08", "2022-02-09", "2022-02-10", "2022-02-11", "2022-02-12", "2022-02-13", "2022-02-14",
-  "2022-02-15", "2022-02-16", "2022-02-17", "2022-02-18", "2022-02-19", "2022-02-20", "2022-02-21", "2022-02-22", "2022-02-23", "2022-02-24",
-  "2022-02-25", "2022-02-26", "2022-02-27", "2022-02-28", "2022-03-01", "2022-03-02", "2022-03-03", "2022-03-04", "2022-03-05", "2022-03-06",
-  "2022-03-07", "2022-03-08", "2022-03-09", "2022-03-10", "2022-03-11", "2022-03-12", "2022-03-13", "2022-03-14", "2022-03-15", "2022-03-16",
-  "2022-03-17", "2022-03-18", "2022-03-19", "2022-03-20", "2022-03-21", "2022-03-22", "2022-03-23", "2022-03-24", "2022-03-25", "2022-03-26",
-  "2022-03-27", "2022-03-28", "2022-03-29", "2022-03-30", "2022-03-31", "2022-04-01", "2022-04-02", "2022-04-03", "2022-04-04", "2022-04-05",
-  "2022-04-06", "2022-04-07", "2022-04-08", "2022-04-09", "2022-04-10", "2022-04-11", "2022-04-12", "2022-04-13", "2022-04-14", "2022-04-15",
-  "2022-04-16", "2022-04-17", "2022-04-18", "2022-04-19", "2022-04-20", "2022-04-21", "2022-04-22", "2022-04-23", "2022-04-24", "2022-04-25",
-  "2022-04-26", "2022-04-27", "2022-04-28", "2022-04-29", "2022-04-30", "2022-05-01", "2022-05-02", "2022-05-03", "2022-05-04", "2022-05-05",
-  "2022-05-06", "2022-05-07", "2022-05-08", "2022-05-09", "2022-05-10", "2022-05-11", "2022-05-12", "2022-05-13", "2022-05-14", "2022-05-15",
-  "2022-05-16", "2022-05-17", "2022-05-18", "2022-05-19", "2022-05-20", "2022-05-21", "2022-05-22", "2022-05-23", "2022-05-24", "2022-05-25",
-  "2022-05-26", "2022-05-27", "2022-05-28", "2022-05-29", "2022-05-30", "2022-05-31", "2022-06-01", "2022-06-02", "2022-06-03", "2022-06-04",
-  "2022-06-05", "2022-06-06", "2022-06-07", "2022-06-08", "2022-06-09", "2022-06-10", "2022-06-11", "2022-06-12", "2022-06-13", "2022-06-14",
-  "2022-06-15", "2022-06-16", "2022-06-17", "2022-06-18", "2022-06-19", "2022-06-20", "2022-06-21", "2022-06-22", "2022-06-23", "2022-06-24",
-  "2022-06-25", "2022-06-26", "2022-06-27", "2022-06-28", "2022-06-29", "2022-06-30", "2022-07-01", "2022-07-02", "2022-07-03", "2022-07-04",
-  "2022-07-05", "2022-07-06", "2022-07-07", "2022-07-08", "2022-07-09", "2022-07-10", "2022-07-11", "2022-07-12", "2022-07-13", "2022-07-14",
-  "2022-07-15", "2022-07-16", "2022-07-17", "2022-07-18", "2022-07-19", "2022-07-20", "2022-07-21", "2022-07-22", "2022-07-23", "2022-07-24",
-  "2022-07-25", "2022-07-26", "2022-07-27", "2022-07-28", "2022-07-29", "2022-07-30", "2022-07-31", "2022-08-01", "2022-08-02", "2022-08-03",
-  "2022-08-04", "2022-08-05", "2022-08-06", "2022-08-07", "2022-08-08", "2022-08-09", "2022-08-10", "2022-08-11", "2022-08-12", "2022-08-13",
-  "2022-08-14", "2022-08-15", "2022-08-16", "2022-08-17", "2022-08-18", "2022-08-19", "2022-08-20", "2022-08-21", "2022-08-22", "2022-08-23",
-  "2022-08-24", "2022-08-25", "2022-08-26", "2022-08-27", "2022-08-28", "2022-08-29", "2022-08-30", "2022-08-31", "2022-09-01", "2022-09-02",
-  "2022-09-03", "2022-09-04", "2022-09-05", "2022-09-06", "2022-09-07", "2022-09-08", "2022-09-09", "2022-09-10", "2022-09-11", "2022-09-12",
-  "2022-09-13", "2022-09-14", "2022-09-15", "2022-09-16", "2022-09-17", "2022-09-18", "2022-09-19", "2022-09-20", "2022-09-21", "2022-09-22",
-  "2022-09-23", "2022-09-24", "2022-09-25", "2022-09-26", "2022-09-27", "2022-09-28", "2022-09-29", "2022-09-30", "2022-10-01", "2022-10-02",
-  "2022-10-03", "2022-10-04", "2022-10-05", "2022-10-06", "2022-10-07", "2022-10-08", "2022-10-09", "2022-10-10", "2022-10-11", "2022-10-12",
-  "2022-10-13", "2022-10-14", "2022-10-15", "2022-10-16", "2022-10-17", "2022-10-18", "2022-10-19", "2022-10-20", "2022-10-21", "2022-10-22",
-  "2022-10-23", "2022-10-24", "2022-10-25", "2022-10-26", "2022-10-27", "2022-10-28", "2022-10-29", "2022-10-30", "2022-10-31", "2022-11-01",
-  "2022-11-02", "2022-11-03", "2022-11-04", "2022-11-05", "2022-11-06", "2022-11-07", "2022-11-08", "2022-11-09", "2022-11-10", "2022-11-11",
-  "2022-11-12", "2022-11-13", "2022-11-14", "2022-11-15", "2022-11-16", "2022-11-17", "2022-11-18", "2022-11-19", "2022-11-20", "2022-11-21",
-  "2022-11-22", "2022-11-23", "2022-11-24", "2022-11-25", "2022-11-26", "2022-11-27", "2022-11-28", "2022-11-29", "2022-11-30", "2022-12-01",
-  "2022-12-02", "2022-12-03", "2022-12-04", "2022-12-05", "2022-12-06", "2022-12-07", "2022-12-08", "2022-12-09", "2022-12-10", "2022-12-11",
-  "2022-12-12", "2022-12-13", "2022-12-14", "2022-12-15", "2022-12-16", "2022-12-17", "2022-12-18", "2022-12-19", "2022-12-20", "2022-12-21",
-  "2022-12-22", "2022-12-23", "2022-12-24", "2022-12-25", "2022-12-26", "2022-12-27", "2022-12-28", "2022-12-29", "2022-12-30", "2022-12-31"
-};
+inline constexpr long raw_first_day = days_from_civil(RAW_DATA_FIRST_YEAR, 1, 1);
+
+static_assert(days_from_civil(RAW_DATA_FIRST_YEAR + 2, 1, 1) - raw_first_day == RAW_DATA_DAYS,
+    "the daily tables must cover two whole years");
+
+// Index of a calendar date into the daily tables (0 = 2021-01-01); dates
+// outside the covered two years wrap around onto the tables
+constexpr int dayIndex(int year, int month, int day)
+{
+  long index = (days_from_civil(year, month, day) - raw_first_day) % RAW_DATA_DAYS;
+  return index < 0 ? index + RAW_DATA_DAYS : index;
+}
+
+// Index of a calendar month into the monthly tables (0 = 2021-01)
+constexpr int monthIndex(int year, int month)
+{
+  int index = ((year - RAW_DATA_FIRST_YEAR) * 12 + month - 1) % RAW_DATA_MONTHS;
+  return index < 0 ? index + RAW_DATA_MONTHS : index;
+}
+
+constexpr struct weather weatherForDay(int index)
+{
+  struct weather ret = {};
+
+  ret.temp_min = raw_temp_min[index];
+  ret.temp_max = raw_temp_max[index];
+  ret.temp_avg = raw_temp_avg[index];
+  ret.humid_min = raw_humid_min[index];
+  ret.humid_max = raw_humid_max[index];
+  ret.humid_avg = raw_humid_avg[index];
+
+  return ret;
+}
+
+constexpr int powerForMonth(int index)
+{
+  return raw_power_avg[index];
+}
+
+// Share of the daily consumption in the given hour of day (sums to 1.0)
+constexpr double hourShare(int hour)
+{
+  return raw_hour_profile[hour];
+}
+
+static_assert(dayIndex(2021, 1, 1) == 0 && dayIndex(2023, 1, 1) == 0, "dayIndex");
+static_assert(monthIndex(2022, 12) == RAW_DATA_MONTHS - 1, "monthIndex");
 
-// index (month)
-const char *month[] = {
-  "2021-01", "2021-02", "2021-03", "2021-04", "2021-05", "2021-06", "2021-07", "2021-08", "2021-09", "2021-10",
-  "2021-11", "2021-12", "2022-01", "2022-02", "2022-03", "2022-04", "2022-05", "2022-06", "2022-07", "2022-08",
-  "2022-09", "2022-10", "2022-11", "2022-12"
-};
 #endif /* __RAW_DATA_H__ */
@@ -0,0 +1,138 @@
+#include <cstdlib>
+#include <cstring>
+#include "serial_index.h"
+
+SerialIndex::SerialIndex()
+{
+  this->directory = NULL;
+  this->slots = NULL;
+  this->mask = 0;
+  this->count = 0;
+}
+
+SerialIndex::~SerialIndex()
+{
+  free(this->slots);
+}
+
+// Mixes the two 8-byte halves of a zero-padded 16-byte serial
+uint64_t SerialIndex::hash(const char *serial)
+{
+  uint64_t a, b, h;
+
+  memcpy(&a, serial, 8);
+  memcpy(&b, serial + 8, 8);
+  h = a * 0x9e3779b97f4a7c15ULL ^ (b + 0x632be59bd9b4e019ULL) * 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 32;
+  h *= 0x94d049bb133111ebULL;
+  return h ^ (h >> 29);
+}
+
+void SerialIndex::place(uint64_t h, uint32_t index)
+{
+  uint32_t pos, tag;
+
+  tag = (uint32_t)(h >> 32) | 1;
+  pos = (uint32_t)h & this->mask;
+  while (this->slots[pos].tag)
+    pos = (pos + 1) & this->mask;
+  this->slots[pos].tag = tag;
+  this->slots[pos].index = index;
+}
+
+// Grows the table to hold 'capacity' customers and re-places the old slots
+void SerialIndex::resize(uint32_t capacity)
+{
+  struct serial_slot *old;
+  uint32_t size, old_size, pos;
+  uint64_t h;
+  char key[SERIAL_LEN];
+  string_view serial;
+
+  size = 16;
+  while (size < capacity * 2)
+    size <<= 1;
+
+  old = this->slots;
+  old_size = old ? this->mask + 1 : 0;
+  this->slots = (struct serial_slot *)calloc(size, sizeof(struct serial_slot));
+  this->mask = size - 1;
+
+  for (pos = 0; pos < old_size; pos++)
+  {
+    if (!old[pos].tag)
+      continue;
+    serial = this->directory->getSerial(old[pos].index);
+    memset(key, 0, SERIAL_LEN);
+    memcpy(key, serial.data(), serial.size());
+    h = hash(key);
+    this->place(h, old[pos].index);
+  }
+  free(old);
+}
+
+void SerialIndex::build(CustomerDirectory *directory)
+{
+  uint32_t num;
+
+  this->directory = directory;
+  num = directory->size();
+  free(this->slots);
+  this->slots = NULL;
+  this->count = 0;
+  this->resize(num);
+  for (uint32_t i=0; i<num; i++)
+    this->insert(i);
+}
+
+void SerialIndex::insert(uint32_t index)
+{
+  char key[SERIAL_LEN];
+  string_view serial;
+
+  // keep the load factor at or below one half
+  if (!this->slots || (this->count + 1) * 2 > this->mask + 1)
+    this->resize((this->count + 1) * 2);
+
+  serial = this->directory->getSerial(index);
+  memset(key, 0, SERIAL_LEN);
+  memcpy(key, serial.data(), serial.size());
+  this->place(hash(key), index);
+  this->count++;
+}
+
+int64_t SerialIndex::find(string_view serial)
+{
+  char key[SERIAL_LEN];
+  uint64_t h;
+  uint32_t pos, tag;
+  struct serial_slot *slot;
+
+  if (!this->slots || serial.size() > SERIAL_LEN)
+    return -1;
+
+  memset(key, 0, SERIAL_LEN);
+  memcpy(key, serial.data(), serial.size());
+  h = hash(key);
+  tag = (uint32_t)(h >> 32) | 1;
+  pos = (uint32_t)h & this->mask;
+
+  for (slot = &this->slots[pos]; slot->tag; slot = &this->slots[pos])
+  {
+    if (slot->tag == tag && this->directory->getSerial(slot->index) == serial)
+      return slot->index;
+    pos = (pos + 1) & this->mask;
+  }
+
+  return -1;
+}
+
+uint32_t SerialIndex::size()
+{
+  return this->count;
+}
+
+CustomerDirectory *SerialIndex::getDirectory()
+{
+  return this->directory;
+}
@@ -0,0 +1,47 @@
+#ifndef __SERIAL_INDEX_H__
+#define __SERIAL_INDEX_H__
+
+#include <cstdint>
+#include <string_view>
+#include "customer_directory.h"
+
+using namespace std;
+
+// One slot of the table: a tag from the hash (0 = empty) and the customer
+// index; the serial itself is compared against the directory on a tag hit
+struct serial_slot
+{
+  uint32_t tag;
+  uint32_t index;
+};
+
+// Serial number -> customer index, open addressing with linear probing
+// over a flat power-of-two slot array kept at most half full
+class SerialIndex
+{
+  private:
+    CustomerDirectory *directory;
+    struct serial_slot *slots;
+    uint32_t mask;
+    uint32_t count;
+
+    static uint64_t hash(const char *serial);
+    void place(uint64_t h, uint32_t index);
+    void resize(uint32_t capacity);
+
+  public:
+    SerialIndex();
+    ~SerialIndex();
+
+    // Indexes every customer of the directory
+    void build(CustomerDirectory *directory);
+    // Indexes one customer appended to the directory after build()
+    void insert(uint32_t index);
+    // Returns the customer index, or -1 if the serial is unknown
+    int64_t find(string_view serial);
+
+    uint32_t size();
+    CustomerDirectory *getDirectory();
+};
+
+#endif /* __SERIAL_INDEX_H__ */
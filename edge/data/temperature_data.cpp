@@ -1,23 +1,21 @@
 #include "temperature_data.h"
 
+TemperatureData::TemperatureData()
+{
+  this->timestamp = 0;
+  this->avg = 0;
+  this->min = 0;
+  this->max = 0;
+  this->unit = UNIT_CELSIUS;
+}
+
 TemperatureData::TemperatureData(time_t timestamp, double min, double max, double avg)
 {
   this->timestamp = timestamp;
   this->avg = avg;
   this->min = min;
   this->max = max;
-  this->next = NULL;
-  this->unit = "celcius";
-}
-
-void TemperatureData::setNext(TemperatureData *next)
-{
-  this->next = next;
-}
-
-TemperatureData *TemperatureData::getNext()
-{
-  return this->next;
+  this->unit = UNIT_CELSIUS;
 }
 
 void TemperatureData::setValue(double value)
@@ -60,7 +58,7 @@ time_t TemperatureData::getTimestamp()
   return this->timestamp;
 }
 
-string TemperatureData::getUnit()
+enum unit TemperatureData::getUnit()
 {
   return this->unit;
 }
@@ -1,10 +1,9 @@
 #ifndef __TEMPERATURE_H__
 #define __TEMPERATURE_H__
 
-#include <random>
 #include <ctime>
-#include <string>
-#include "info.h"
+#include <type_traits>
+#include "unit.h"
 
 class TemperatureData
 {
@@ -13,14 +12,11 @@ class TemperatureData
     double avg;
     double min;
     double max;
-    string unit;
-    TemperatureData *next;
+    enum unit unit;
   public:
+    TemperatureData();
     TemperatureData(time_t timestamp, double min, double max, double avg);
 
-    void setNext(TemperatureData *data);
-    TemperatureData *getNext();
-
     void setValue(double value);
     double getValue();
 
@@ -33,7 +29,10 @@ class TemperatureData
     void setTimestamp(time_t timestamp);
     time_t getTimestamp();
 
-    string getUnit();
+    enum unit getUnit();
 };
 
+// Plain value type: lives by value in DataSet and can be memcpy'd
+static_assert(std::is_trivially_copyable<TemperatureData>::value, "TemperatureData must stay trivially copyable");
+
 #endif /* __TEMPERATURE_H__ */
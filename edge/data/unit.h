@@ -0,0 +1,26 @@
+#ifndef __UNIT_H__
+#define __UNIT_H__
+
+// Unit of a measured value
+enum unit
+{
+  UNIT_CELSIUS,
+  UNIT_PERCENT,
+  UNIT_KWH
+};
+
+inline const char *unit_name(enum unit u)
+{
+  switch (u)
+  {
+    case UNIT_CELSIUS:
+      return "celcius";
+    case UNIT_PERCENT:
+      return "%";
+    case UNIT_KWH:
+      return "kWh";
+  }
+  return "";
+}
+
+#endif /* __UNIT_H__ */
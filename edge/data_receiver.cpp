@@ -2,18 +2,41 @@
 #include <iostream>
 #include "data_receiver.h"
 #include "data/raw_data.h"
+#include "data/calendar.h"
 #include "data/power_data.h"
 #include "data/temperature_data.h"
 #include "data/humidity_data.h"
 #include "data/house_data.h"
+#include "data/customer_generator.h"
+#include "metrics.h"
+#include "logger.h"
 
 using namespace std;
 
 DataReceiver::DataReceiver()
 {
   this->num = 0;
-  for (int i=0; i<NUM_OF_CUSTOMER; i++)
-    this->info[i] = NULL;
+  this->hours = 1;
+  this->seed = ((uint64_t)random_device()() << 32) | random_device()();
+  this->directory = new CustomerDirectory();
+  this->index = new SerialIndex();
+  this->writer = NULL;
+  this->reader = NULL;
+  this->csv = NULL;
+  this->has_pending = false;
+  this->customers = 0;
+  this->max_customers = NUM_OF_CUSTOMER;
+  this->unknown = 0;
+  this->late = 0;
+}
+
+DataReceiver::~DataReceiver()
+{
+  delete this->writer;
+  delete this->reader;
+  delete this->csv;
+  delete this->index;
+  delete this->directory;
 }
 
 int DataReceiver::getNumOfPeriod()
@@ -21,65 +44,235 @@ int DataReceiver::getNumOfPeriod()
   return this->num;
 }
 
+void DataReceiver::setHourly(bool hourly)
+{
+  this->hours = hourly ? 24 : 1;
+}
+
+bool DataReceiver::isHourly()
+{
+  return this->hours == 24;
+}
+
+void DataReceiver::setSeed(uint64_t seed)
+{
+  this->seed = seed;
+}
+
+uint64_t DataReceiver::getSeed()
+{
+  return this->seed;
+}
+
+int DataReceiver::setRecordFile(const char *path, bool portable)
+{
+  delete this->writer;
+  this->writer = new DataSetWriter();
+  return this->writer->open(path, portable);
+}
+
+int DataReceiver::setReplayFile(const char *path)
+{
+  delete this->reader;
+  this->reader = new DataSetReader();
+  return this->reader->open(path);
+}
+
+int DataReceiver::setInputFile(const char *path)
+{
+  delete this->csv;
+  this->csv = new MeterCsvReader();
+  this->has_pending = false;
+  return this->csv->open(path);
+}
+
+void DataReceiver::setNumOfCustomer(int num)
+{
+  this->max_customers = num;
+}
+
+int DataReceiver::getNumOfCustomer()
+{
+  return this->csv ? this->customers : this->getMaxNumOfCustomer();
+}
+
+int DataReceiver::getMaxNumOfCustomer()
+{
+  return this->reader ? this->reader->getNumOfCustomer() : this->max_customers;
+}
+
+int64_t DataReceiver::findCustomer(string_view serial)
+{
+  return this->index->find(serial);
+}
+
 void DataReceiver::init()
 {
   double mean, stdev;
+  CustomerGenerator gen(this->seed);
+
+  // with a meter file, the customers are the meters found in the file
+  this->directory->clear();
+  if (!this->csv)
+    gen.generate(this->directory, this->max_customers);
+  this->index->build(this->directory);
 
-  for (int i=0; i<NUM_OF_CUSTOMER; i++)
-    this->info[i] = new Info(i);
+  // per-hour share of the daily consumption, with 10% spread per hour
+  for (int h=0; h<24; h++)
+  {
+    mean = hourShare(h);
+    stdev = mean * 0.1;
+    this->dist[h] = normal_distribution<double>(mean, stdev);
+  }
+  this->generator.seed(this->seed);
 }
 
 DataSet *DataReceiver::getDataSet(time_t timestamp)
 {
   DataSet *ret;
-  HouseData *data;
-  PowerData *power;
-  TemperatureData *temp;
-  HumidityData *humid;
   int mean, stdev;
-  struct tm *tm;
-  char buf[11];
-  int midx, didx, value;
+  struct civil_date date;
+  struct weather w;
+  int midx, didx;
+
+  METRIC_SCOPE(TIMER_GENERATE);
+  if (this->reader)
+  {
+    this->num++;
+    return this->reader->getDataSet(timestamp);
+  }
 
   ret = new DataSet(timestamp);
-  tm = localtime(&timestamp);
-  snprintf(buf, 11, "%04d-%02d-%02d", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+  ret->setSerialIndex(this->index);
+  date = localDate(timestamp);
+  midx = monthIndex(date.year, date.month);
+  didx = dayIndex(date.year, date.month, date.day);
+
+  mean = powerForMonth(midx);
+  stdev = (int) (mean * 0.2);
+
+  w = weatherForDay(didx);
+  ret->setTemperatureData(TemperatureData(timestamp, w.temp_min, w.temp_max, w.temp_avg));
+  ret->setHumidityData(HumidityData(timestamp, w.humid_min, w.humid_max, w.humid_avg));
+
+  if (this->csv)
+    this->readMeterData(ret, timestamp);
+  else
+    this->generatePowerData(ret, timestamp, mean, stdev);
+
+  // meters appear part-way through a meter file, so its recording keeps
+  // the full width of the limit (unseen meters read 0)
+  if (this->writer)
+    this->writer->write(ret, this->csv ? this->max_customers : 0);
+
+  this->num++;
+  return ret;
+}
+
+// Draws every house's consumption around the monthly mean
+void DataReceiver::generatePowerData(DataSet *ds, time_t timestamp, int mean, int stdev)
+{
+  int value, hours, num;
+  float *column, *row;
+  double ratio, sum;
 
-  for (midx=0; midx<24; midx++)
+  normal_distribution<float> dist(mean, stdev);
+
+  // readings are written straight into one contiguous column for the whole
+  // day; the per-house PowerData keeps the daily total
+  hours = this->hours;
+  num = this->max_customers;
+  column = new float[(size_t)num * hours];
+
+  ds->reserveHouseData(num);
+  for (int i=0; i<num; i++)
   {
-    if (!strncmp(buf, month[midx], 7))
-      break;
+    value = (int) dist(this->generator);
+    row = column + i * hours;
+
+    if (hours == 1)
+      row[0] = value;
+    else
+    {
+      sum = 0;
+      for (int h=0; h<hours; h++)
+      {
+        ratio = this->dist[h](this->generator);
+        if (ratio < 0)
+          ratio = 0;
+        row[h] = (float) (value * ratio);
+        sum += row[h];
+      }
+      value = (int) sum;
+    }
+
+    ds->addHouseData(HouseData(i, PowerData(timestamp, value)));
   }
+  ds->setPowerColumn(column, hours, true);
+}
 
-  mean = power_avg[midx];
-  stdev = (int) (mean * 0.2);
+// Accumulates the meter records of [timestamp, timestamp + 1 day) per
+// customer; the first record of the next day is kept for the next call
+void DataReceiver::readMeterData(DataSet *ds, time_t timestamp)
+{
+  int64_t idx;
+  int hour, hours;
+  float *column, *row;
+  double sum;
+  string_view serial;
+  long unknown, late;
 
-  for (didx=0; didx<730; didx++)
+  hours = this->hours;
+  column = new float[(size_t)this->max_customers * hours]();
+  unknown = this->unknown;
+  late = this->late;
+
+  while (this->has_pending || this->csv->next(&this->pending) == SUCCESS)
   {
-    if (!strncmp(buf, date[didx], 10))
+    this->has_pending = true;
+    if (this->pending.timestamp >= timestamp + 86400)
       break;
-  }
+    this->has_pending = false;
+    if (this->pending.timestamp < timestamp)
+    {
+      this->late++;
+      continue;
+    }
 
-  temp = new TemperatureData(timestamp, temp_min[didx], temp_max[didx], temp_avg[didx]);
-  ret->setTemperatureData(temp);
+    serial = string_view(this->pending.serial, this->pending.serial_len);
+    idx = this->index->find(serial);
+    if (idx < 0)
+    {
+      if (this->customers >= this->max_customers)
+      {
+        this->unknown++;
+        continue;
+      }
+      idx = this->directory->add(serial, "", "");
+      this->index->insert(idx);
+      this->customers++;
+    }
 
-  humid = new HumidityData(timestamp, humid_min[didx], humid_max[didx], humid_avg[didx]);
-  ret->setHumidityData(humid);
+    hour = (hours == 1) ? 0 : (this->pending.timestamp - timestamp) / 3600;
+    column[idx * hours + hour] += this->pending.kwh;
+  }
 
-  srand(time(NULL));
-  random_device rd;
-  mt19937 gen(rd());
-  normal_distribution<float> dist(mean, stdev);
+  if (this->late > late)
+    LOG_WARN("[!] %ld meter records older than the day were dropped (the input must be sorted by time)\n",
+        this->late - late);
+  if (this->unknown > unknown)
+    LOG_WARN("[!] %ld meter records of meters past the limit of %d were dropped\n",
+        this->unknown - unknown, this->max_customers);
 
-  for (int i=0; i<NUM_OF_CUSTOMER; i++)
+  ds->reserveHouseData(this->customers);
+  for (int i=0; i<this->customers; i++)
   {
-    data = new HouseData(this->info[i]);
-    value = (int) dist(gen);
-    power = new PowerData(timestamp, value);
-    data->setPowerData(power);
-    ret->addHouseData(data);
-  }
+    row = column + i * hours;
+    sum = 0;
+    for (int h=0; h<hours; h++)
+      sum += row[h];
 
-  this->num++;
-  return ret;
+    ds->addHouseData(HouseData(i, PowerData(timestamp, sum)));
+  }
+  ds->setPowerColumn(column, hours, true);
 }
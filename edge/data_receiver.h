@@ -4,8 +4,12 @@
 #include <ctime>
 #include <random>
 #include "data/info.h"
+#include "data/customer_directory.h"
+#include "data/serial_index.h"
 #include "data/data.h"
 #include "data/dataset.h"
+#include "data/dataset_file.h"
+#include "data/meter_csv.h"
 #include "setting.h"
 
 using namespace std;
@@ -13,15 +17,62 @@ using namespace std;
 class DataReceiver {
   private:
     int num;
-    Info *info[NUM_OF_CUSTOMER];
+    int hours;
+    uint64_t seed;
+    CustomerDirectory *directory;   // customers of this receiver's DataSets
     default_random_engine generator;
     normal_distribution<double> dist[24];
+    DataSetWriter *writer;
+    DataSetReader *reader;
+    MeterCsvReader *csv;
+    struct meter_record pending;
+    bool has_pending;
+    int customers;          // meters found so far (meter CSV input)
+    int max_customers;      // customers generated, or the meter limit
+    long unknown;           // records of meters past the limit, dropped
+    long late;              // records older than the day read, dropped
+    SerialIndex *index;
+
+    void generatePowerData(DataSet *ds, time_t timestamp, int mean, int stdev);
+    void readMeterData(DataSet *ds, time_t timestamp);
 
   public:
     DataReceiver();
+    ~DataReceiver();
 
     int getNumOfPeriod();
 
+    // Hourly mode produces 24 readings per house per day instead of one
+    void setHourly(bool hourly);
+    bool isHourly();
+
+    // Customers and readings are reproducible for a given seed (set before
+    // init(); the default is a random seed per DataReceiver)
+    void setSeed(uint64_t seed);
+    uint64_t getSeed();
+
+    // Records every generated DataSet to 'path', or serves DataSets from
+    // a recording instead of generating them
+    int setRecordFile(const char *path, bool portable = false);
+    int setReplayFile(const char *path);
+
+    // Reads the power readings from a smart-meter CSV export
+    // ("timestamp,serial,kWh") instead of generating them. The records
+    // must be sorted by time: a record older than the day being read is
+    // dropped, as is a record of a new meter past the customer limit
+    // (both are counted and logged per day)
+    int setInputFile(const char *path);
+
+    // Customers per DataSet (set before init(); default NUM_OF_CUSTOMER);
+    // with a meter CSV it is the limit of meters tracked
+    void setNumOfCustomer(int num);
+    int getNumOfCustomer();
+    // Upper bound of the houses in any DataSet this receiver returns
+    int getMaxNumOfCustomer();
+
+    // Customer index of a meter serial, or -1
+    int64_t findCustomer(string_view serial);
+
     void init();
     DataSet *getDataSet(time_t timestamp);
 };
@@ -1,7 +1,11 @@
 #include "edge.h"
 #include "opcode.h"
-#include <iostream>
+#include "vector_layout.h"
+#include "logger.h"
+#include "metrics.h"
 #include <ctime>
+#include <cstdlib>
+#include <vector>
 using namespace std;
 
 Edge::Edge() 
@@ -9,7 +13,15 @@ Edge::Edge()
   this->dr = new DataReceiver();
   this->nm = new NetworkManager();
   this->pm = new ProcessManager();
+  this->hs = NULL;
+  this->history = NULL;
+  this->keep_history = false;
+  this->seeded = false;
+  this->customers = NUM_OF_CUSTOMER;
+  this->history_days = HISTORY_DAYS;
   this->vector_id = 2;  // 기본값: 5D
+  this->batch = 1;
+  this->start = 1609459200;
 }
 
 Edge::~Edge()
@@ -17,6 +29,7 @@ Edge::~Edge()
   delete this->dr;
   delete this->nm;
   delete this->pm;
+  delete this->hs;
 }
 
 Edge::Edge(const char *addr, int port)
@@ -24,45 +37,202 @@ Edge::Edge(const char *addr, int port)
   this->dr = new DataReceiver();
   this->nm = new NetworkManager(addr, port);
   this->pm = new ProcessManager();
+  this->hs = NULL;
+  this->history = NULL;
+  this->keep_history = false;
+  this->seeded = false;
+  this->customers = NUM_OF_CUSTOMER;
+  this->history_days = HISTORY_DAYS;
   this->vector_id = 2;  // 기본값: 5D
+  this->batch = 1;
+  this->start = 1609459200;
 }
 
 void Edge::init()
 {
+  this->dr->setNumOfCustomer(this->customers);
+  this->initHistory();
   this->dr->init();
   this->nm->init();
   this->pm->init();
 }
 
+// The history is opt-in: nothing in the pipeline reads it yet. It is
+// opened before the customers are generated, which may use its seed
+void Edge::initHistory()
+{
+  delete this->hs;
+  this->hs = NULL;
+  if (!this->history && !this->keep_history)
+    return;
+  this->hs = new HistoryStore(this->history_days, this->dr->getMaxNumOfCustomer());
+
+  if (this->history)
+  {
+    if (this->hs->open(this->history, this->dr->getSeed()) == FAILURE)
+    {
+      log_flush();
+      exit(1);
+    }
+    if (this->hs->getSeed() != this->dr->getSeed())
+    {
+      if (this->seeded)
+      {
+        LOG_ERROR("[*] Error: %s keeps the customers of seed %llu, not %llu; use -S %llu, or remove the file\n",
+            this->history, (unsigned long long)this->hs->getSeed(),
+            (unsigned long long)this->dr->getSeed(), (unsigned long long)this->hs->getSeed());
+        log_flush();
+        exit(1);
+      }
+      this->dr->setSeed(this->hs->getSeed());
+    }
+    LOG_INFO("[*] History: %d days loaded from %s (seed %llu)\n", this->hs->getNumOfDays(),
+        this->history, (unsigned long long)this->hs->getSeed());
+  }
+  else if (this->hs->init() == FAILURE)
+  {
+    LOG_ERROR("[*] Error: cannot allocate the history of %d days x %d customers\n",
+        this->history_days, this->dr->getMaxNumOfCustomer());
+    log_flush();
+    exit(1);
+  }
+}
+
 void Edge::setVectorID(int id)
 {
   this->vector_id = id;           // vector_id 저장
   this->pm->setVectorID(id);      // ProcessManager에도 설정
 }
 
+void Edge::setHourly(bool hourly)
+{
+  this->dr->setHourly(hourly);
+}
+
+void Edge::setSeed(uint64_t seed)
+{
+  this->dr->setSeed(seed);
+  this->seeded = true;
+}
+
+void Edge::setBatchSize(int batch)
+{
+  this->batch = batch;
+}
+
+void Edge::setNumOfCustomer(int num)
+{
+  this->customers = num;
+}
+
+void Edge::setBufferSize(int bytes)
+{
+  this->nm->setBufferSize(bytes);
+}
+
+void Edge::setHistoryFile(const char *path)
+{
+  this->history = path;
+}
+
+void Edge::setHistory(bool keep)
+{
+  this->keep_history = keep;
+}
+
+void Edge::setHistoryDays(int days)
+{
+  this->history_days = days;
+}
+
+HistoryStore *Edge::getHistoryStore()
+{
+  return this->hs;
+}
+
+int Edge::setRecordFile(const char *path, bool portable)
+{
+  return this->dr->setRecordFile(path, portable);
+}
+
+int Edge::setReplayFile(const char *path)
+{
+  return this->dr->setReplayFile(path);
+}
+
+int Edge::setInputFile(const char *path)
+{
+  return this->dr->setInputFile(path);
+}
+
+void Edge::setStartTime(time_t start)
+{
+  this->start = start;
+}
+
 void Edge::run()
 {
   time_t curr;
   uint8_t opcode;
-  uint8_t *data;
+  uint8_t data[BUFLEN];
   DataSet *ds;
-  int dlen;
+  int dlen, dim, i;
   opcode = OPCODE_DONE;
 
-  cout << "[*] Running the edge device" << endl;
+  LOG_INFO("[*] Running the edge device\n");
 
-  curr = 1609459200;
-  while (opcode != OPCODE_QUIT)
+  // a restart with a kept history continues after its last day
+  curr = this->start;
+  if (this->hs && this->hs->getNumOfDays() > 0 && this->hs->getTimestamp(0) + 86400 > curr)
   {
-    ds = this->dr->getDataSet(curr);
-    data = this->pm->processData(ds, &dlen);
+    curr = this->hs->getTimestamp(0) + 86400;
+    LOG_INFO("[*] Resuming after the last day of the history (%ld)\n", (long)this->hs->getTimestamp(0));
+  }
+
+  if (this->batch <= 1)
+  {
+    while (opcode != OPCODE_QUIT)
+    {
+      METRIC_SCOPE(TIMER_ITERATION);
+      ds = this->dr->getDataSet(curr);
+      METRIC_ADD(COUNTER_RECORDS, 1);
+      if (this->hs)
+        this->hs->append(ds);
+      dlen = this->pm->processData(ds, data);
+      delete ds;
+
+      // ✅ vector_id 포함해서 전송
+      this->nm->sendData(data, dlen, this->vector_id);
+
+      opcode = this->nm->receiveCommand();
+      curr += 86400;
+    }
+  }
+  else
+  {
+    // 'batch' days of vectors per frame, one reply per frame
+    dim = vector_table[this->vector_id].dim;
+    vector<float> values(this->batch * dim);
+
+    while (opcode != OPCODE_QUIT)
+    {
+      METRIC_SCOPE(TIMER_ITERATION);
+      for (i = 0; i < this->batch; i++)
+      {
+        ds = this->dr->getDataSet(curr);
+        if (this->hs)
+          this->hs->append(ds);
+        this->pm->processVector(ds, values.data() + i * dim);
+        delete ds;
+        curr += 86400;
+      }
+      METRIC_ADD(COUNTER_RECORDS, this->batch);
 
-    // ✅ vector_id 포함해서 전송
-    this->nm->sendData(data, dlen, this->vector_id);
+      this->nm->sendBatch(values.data(), this->batch, dim, this->vector_id);
 
-    opcode = this->nm->receiveCommand();
-    curr += 86400;
+      opcode = this->nm->receiveCommand();
+    }
   }
 
-  cout << "[*] End running" << endl;
+  LOG_INFO("[*] End running\n");
 }
\ No newline at end of file
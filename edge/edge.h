@@ -5,13 +5,24 @@
 #include "data_receiver.h"
 #include "network_manager.h"
 #include "process_manager.h"
+#include "data/history_store.h"
 
 class Edge {
   private:
     DataReceiver *dr;
     NetworkManager *nm;
     ProcessManager *pm;
+    HistoryStore *hs;
+    const char *history;
+    bool keep_history;
+    bool seeded;            // setSeed() was called
+    int customers;
+    int history_days;
     int vector_id;
+    int batch;
+    time_t start;
+
+    void initHistory();
 
   public:
     Edge();
@@ -26,6 +37,33 @@ class Edge {
     int getPort();
 
     void setVectorID(int id);
+    void setHourly(bool hourly);
+    // Without a seed, a history file's own seed is restored (its
+    // customers are regenerated); a different seed is refused
+    void setSeed(uint64_t seed);
+    // Days per frame; above 1 the vectors are sent as OPCODE_BATCH frames
+    void setBatchSize(int batch);
+    // Houses per day (default NUM_OF_CUSTOMER); every per-customer
+    // structure is sized from it in init()
+    void setNumOfCustomer(int num);
+    // Socket buffer size in bytes (0: system default)
+    void setBufferSize(int bytes);
+
+    // Keeps the per-house history (off by default); with a file it
+    // survives restarts, and run() resumes after its last day
+    void setHistory(bool keep);
+    void setHistoryFile(const char *path);
+    // Days kept per house (default HISTORY_DAYS)
+    void setHistoryDays(int days);
+    // NULL before init() or without a history
+    HistoryStore *getHistoryStore();
+
+    int setRecordFile(const char *path, bool portable = false);
+    int setReplayFile(const char *path);
+    int setInputFile(const char *path);
+
+    // Timestamp of the first day to process
+    void setStartTime(time_t start);
 
     void init();
     void run();
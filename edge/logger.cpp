@@ -0,0 +1,219 @@
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "logger.h"
+
+using namespace std;
+
+// One message; 'seq' tells whose turn the slot is (bounded MPMC ring by
+// D. Vyukov): pos when free for the producer of pos, pos + 1 when filled
+struct log_record
+{
+  atomic<uint64_t> seq;
+  uint16_t len;
+  char text[LOG_LINE];
+};
+
+atomic<int> log_threshold(LOG_LEVEL_INFO);
+
+static struct log_record queue[LOG_QUEUE_SIZE];
+static atomic<uint64_t> head(0);      // next slot to fill
+static atomic<uint64_t> tail(0);      // next slot to write out
+static atomic<uint64_t> dropped(0);
+static atomic<bool> running(false);
+static atomic<bool> stopping(false);
+static atomic<uint32_t> doorbell(0);  // bumped to wake the writer
+static atomic<uint32_t> sleeping(0);  // the writer is (about to be) asleep
+static once_flag started;
+static pthread_t writer;
+
+// Writes out every filled slot; only one thread drains at a time
+static bool drain()
+{
+  struct log_record *rec;
+  uint64_t pos;
+  bool any;
+
+  any = false;
+  pos = tail.load(memory_order_relaxed);
+  for (;;)
+  {
+    rec = &queue[pos & (LOG_QUEUE_SIZE - 1)];
+    if (rec->seq.load(memory_order_acquire) != pos + 1)
+      break;
+    fwrite(rec->text, 1, rec->len, stdout);
+    rec->seq.store(pos + LOG_QUEUE_SIZE, memory_order_release);
+    pos++;
+    tail.store(pos, memory_order_release);
+    any = true;
+  }
+  if (any)
+    fflush(stdout);
+  return any;
+}
+
+static long futex(atomic<uint32_t> *word, int op, uint32_t val)
+{
+  return syscall(SYS_futex, (uint32_t *)word, op, val, NULL, NULL, 0);
+}
+
+static bool ready()
+{
+  uint64_t pos = tail.load(memory_order_relaxed);
+
+  return queue[pos & (LOG_QUEUE_SIZE - 1)].seq.load(memory_order_acquire) == pos + 1;
+}
+
+// The writer flags itself before it checks the ring for the last time, a
+// producer publishes its slot before it checks the flag (with a full fence
+// on both sides), so one of them always sees the other
+static void ring_doorbell()
+{
+  atomic_thread_fence(memory_order_seq_cst);
+  if (sleeping.load(memory_order_relaxed))
+  {
+    doorbell.fetch_add(1);
+    futex(&doorbell, FUTEX_WAKE_PRIVATE, 1);
+  }
+}
+
+static void *writer_main(void *arg)
+{
+  uint32_t observed;
+
+  (void)arg;
+  while (!stopping.load(memory_order_acquire))
+  {
+    if (drain())
+      continue;
+
+    observed = doorbell.load();
+    sleeping.store(1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!ready() && !stopping.load(memory_order_acquire))
+      futex(&doorbell, FUTEX_WAIT_PRIVATE, observed);
+    sleeping.store(0, memory_order_relaxed);
+  }
+  drain();
+  return NULL;
+}
+
+static void log_shutdown()
+{
+  if (!running.exchange(false))
+    return;
+  stopping.store(true, memory_order_release);
+  ring_doorbell();
+  pthread_join(writer, NULL);
+
+  if (dropped.load(memory_order_relaxed) > 0)
+  {
+    printf("[!] %llu log messages dropped (the log queue was full)\n",
+        (unsigned long long)dropped.load(memory_order_relaxed));
+    fflush(stdout);
+  }
+}
+
+// The writer thread does not exist in a forked child; log synchronously
+static void after_fork()
+{
+  running.store(false);
+}
+
+static void start()
+{
+  for (uint64_t i=0; i<LOG_QUEUE_SIZE; i++)
+    queue[i].seq.store(i, memory_order_relaxed);
+  if (pthread_create(&writer, NULL, writer_main, NULL) != 0)
+    return;
+  running.store(true);
+  atexit(log_shutdown);
+  pthread_atfork(NULL, NULL, after_fork);
+}
+
+void log_set_level(int level)
+{
+  log_threshold.store(level, memory_order_relaxed);
+}
+
+int log_get_level()
+{
+  return log_threshold.load(memory_order_relaxed);
+}
+
+void log_write(int level, const char *fmt, ...)
+{
+  struct log_record *rec;
+  uint64_t pos, seq;
+  int64_t diff;
+  va_list ap;
+  int len;
+
+  (void)level;
+  call_once(started, start);
+
+  // Before start-up finished, after exit or in a forked child
+  if (!running.load(memory_order_acquire))
+  {
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    fflush(stdout);
+    return;
+  }
+
+  // Claim a slot
+  pos = head.load(memory_order_relaxed);
+  for (;;)
+  {
+    rec = &queue[pos & (LOG_QUEUE_SIZE - 1)];
+    seq = rec->seq.load(memory_order_acquire);
+    diff = (int64_t)seq - (int64_t)pos;
+    if (diff == 0)
+    {
+      if (head.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    {
+      dropped.fetch_add(1, memory_order_relaxed);
+      return;
+    }
+    else
+      pos = head.load(memory_order_relaxed);
+  }
+
+  va_start(ap, fmt);
+  len = vsnprintf(rec->text, LOG_LINE, fmt, ap);
+  va_end(ap);
+  if (len < 0)
+    len = 0;
+  if (len >= LOG_LINE)
+  {
+    len = LOG_LINE;
+    rec->text[LOG_LINE - 1] = '\n';
+  }
+  rec->len = len;
+  rec->seq.store(pos + 1, memory_order_release);
+  ring_doorbell();
+}
+
+void log_flush()
+{
+  uint64_t target;
+
+  target = head.load(memory_order_acquire);
+  while (running.load(memory_order_acquire) && tail.load(memory_order_acquire) < target)
+    usleep(100);
+}
+
+uint64_t log_dropped()
+{
+  return dropped.load(memory_order_relaxed);
+}
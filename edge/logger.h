@@ -0,0 +1,69 @@
+#ifndef __LOGGER_H__
+#define __LOGGER_H__
+
+#include <atomic>
+#include <cstdint>
+
+// Leveled, asynchronous logging. A call formats the message into a slot
+// of a fixed lock-free ring and returns; a background thread writes the
+// ring to stdout, sleeping on a futex while the ring is empty. When the
+// ring is full the message is dropped (and counted) instead of blocking
+// the caller. Everything queued is written at exit, followed by the
+// number of dropped messages, if any
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+// Levels below this are compiled out (e.g. -DLOG_COMPILE_LEVEL=0 keeps
+// the debug messages)
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_QUEUE_SIZE 1024   // slots, a power of two
+#define LOG_LINE 248          // bytes per message, longer ones are cut
+
+// Read on every call (relaxed); set with log_set_level()
+extern std::atomic<int> log_threshold;
+
+// Runtime threshold on top of the compile-time one
+void log_set_level(int level);
+int log_get_level();
+
+void log_write(int level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+// Returns once every message queued before the call is written; call it
+// before exiting on an error
+void log_flush();
+uint64_t log_dropped();
+
+#define LOG_AT(level, ...) \
+  do { if ((level) >= log_threshold.load(std::memory_order_relaxed)) log_write(level, __VA_ARGS__); } while (0)
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do { } while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do { } while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do { } while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do { } while (0)
+#endif
+
+#endif /* __LOGGER_H__ */
@@ -7,15 +7,41 @@
 
 #include "edge.h"
 #include "data/data.h"
+#include "data/calendar.h"
 #include "setting.h"
+#include "vector_layout.h"
+#include "opcode.h"
+#include "metrics.h"
+#include "logger.h"
+#include "transport.h"
 
 void usage(uint8_t *pname)
 {
   printf(">> Usage: %s [options]\n", pname);
   printf("Options\n");
-  printf("  -a, --addr       Server's address\n");
-  printf("  -p, --port       Server's port\n");
-  printf("  -v, --vector     Vector type (0 = 2D, 1 = 3D, 2 = 5D)\n");
+  printf("  -a, --addr       Server's address: IPv4, IPv6 ([::1] or ::1) or host name\n");
+  printf("                   for TCP, unix:PATH (or /PATH) for a Unix socket, shm:/NAME\n");
+  printf("                   for a collector's shared-memory ring on this host\n");
+  printf("  -p, --port       Server's port (TCP)\n");
+  printf("  -v, --vector     Vector type (0 = 2D, 1 = 3D, 2 = 5D, 3 = 5D load profile,\n");
+  printf("                   4 = 4D moving averages, 5 = 4D running min/max)\n");
+  printf("  -H, --hourly     Generate 24 hourly readings per house per day\n");
+  printf("  -c, --customers  Houses per day (default: %d, at most %d)\n", NUM_OF_CUSTOMER, MAX_CUSTOMERS);
+  printf("  -s, --history    Keep the per-house history in this file; a restart\n");
+  printf("                   continues after its last day with the file's seed\n");
+  printf("                   (default: no history)\n");
+  printf("  -d, --history-days  Days of history kept per house with -s (default: %d)\n", HISTORY_DAYS);
+  printf("  -r, --record     Record the generated DataSets to a file\n");
+  printf("  -P, --portable   Record the columns big-endian (network byte order)\n");
+  printf("  -R, --replay     Replay DataSets from a recorded file\n");
+  printf("  -i, --input      Read the power data from a meter CSV (timestamp,serial,kWh)\n");
+  printf("  -t, --start      Timestamp of the first day (default: 1609459200)\n");
+  printf("  -S, --seed       Seed for reproducible customers and readings\n");
+  printf("  -z, --utc-offset Local time offset from UTC, +HH:MM or seconds (default: system)\n");
+  printf("  -b, --batch      Days of vectors per frame (default: 1, one frame per day)\n");
+  printf("  -B, --buffer     Socket buffer size in bytes (default: system)\n");
+  printf("  -m, --metrics    Log the stage latencies every SEC seconds (0 = only at exit)\n");
+  printf("  -M, --metrics-socket  Serve the metrics (Prometheus text) on a Unix socket\n");
   exit(0);
 }
 
@@ -23,7 +49,23 @@ int main(int argc, char *argv[])
 {
 	int c, tmp, port, vector_id = 2; // default = 5D
   uint8_t *pname, *addr;
+  const char *history = NULL;
+  const char *record = NULL;
+  const char *replay = NULL;
+  const char *input = NULL;
+  time_t start = 1609459200;
+  uint64_t seed = 0;
+  bool seeded = false;
   uint8_t eflag = 0;
+  bool hourly = false;
+  bool portable = false;
+  int batch = 1;
+  int customers = NUM_OF_CUSTOMER;
+  int history_days = HISTORY_DAYS;
+  int buffer = 0;
+  int metrics = -1;
+  const char *metrics_socket = NULL;
+  long offset;
   Edge *edge;
 
   pname = (uint8_t *)argv[0];
@@ -37,10 +79,25 @@ int main(int argc, char *argv[])
       {"addr", required_argument, 0, 'a'},
       {"port", required_argument, 0, 'p'},
       {"vector", required_argument, 0, 'v'},
+      {"hourly", no_argument, 0, 'H'},
+      {"history", required_argument, 0, 's'},
+      {"record", required_argument, 0, 'r'},
+      {"replay", required_argument, 0, 'R'},
+      {"input", required_argument, 0, 'i'},
+      {"start", required_argument, 0, 't'},
+      {"seed", required_argument, 0, 'S'},
+      {"portable", no_argument, 0, 'P'},
+      {"batch", required_argument, 0, 'b'},
+      {"utc-offset", required_argument, 0, 'z'},
+      {"customers", required_argument, 0, 'c'},
+      {"history-days", required_argument, 0, 'd'},
+      {"buffer", required_argument, 0, 'B'},
+      {"metrics", required_argument, 0, 'm'},
+      {"metrics-socket", required_argument, 0, 'M'},
       {0, 0, 0, 0}
     };
 
-    const char *opt = "a:p:v:";
+    const char *opt = "a:p:v:Hs:r:R:i:t:S:Pb:z:m:M:c:d:B:";
 
     c = getopt_long(argc, argv, opt, long_options, &option_index);
 
@@ -51,8 +108,8 @@ int main(int argc, char *argv[])
     {
       case 'a':
         tmp = strlen(optarg);
-        addr = (uint8_t *)malloc(tmp);
-        memcpy(addr, optarg, tmp);
+        addr = (uint8_t *)malloc(tmp + 1);
+        memcpy(addr, optarg, tmp + 1);
         break;
 
       case 'p':
@@ -61,12 +118,97 @@ int main(int argc, char *argv[])
 
       case 'v':
         vector_id = atoi(optarg);
-        if (vector_id < 0 || vector_id > 2) {
-          printf("[!] Invalid vector ID. Use 0 (2D), 1 (3D), or 2 (5D)\n");
+        if (vector_id < 0 || vector_id >= NUM_OF_VECTORS) {
+          printf("[!] Invalid vector ID. Use 0 (2D), 1 (3D), 2 (5D), 3 (5D load profile), 4 or 5 (4D rolling)\n");
           exit(1);
         }
         break;
 
+      case 'H':
+        hourly = true;
+        break;
+
+      case 's':
+        history = optarg;
+        break;
+
+      case 'r':
+        record = optarg;
+        break;
+
+      case 'R':
+        replay = optarg;
+        break;
+
+      case 'i':
+        input = optarg;
+        break;
+
+      case 't':
+        start = atol(optarg);
+        break;
+
+      case 'S':
+        seed = strtoull(optarg, NULL, 0);
+        seeded = true;
+        break;
+
+      case 'P':
+        portable = true;
+        break;
+
+      case 'b':
+        batch = atoi(optarg);
+        if (batch < 1 || batch > BATCH_MAX) {
+          printf("[!] Invalid batch size. Use 1 to %d\n", BATCH_MAX);
+          exit(1);
+        }
+        break;
+
+      case 'z':
+        if (parseUtcOffset(optarg, &offset) == FAILURE) {
+          printf("[!] Invalid UTC offset. Use +HH:MM, -HH:MM or seconds\n");
+          exit(1);
+        }
+        setUtcOffset(offset);
+        break;
+
+      case 'c':
+        customers = atoi(optarg);
+        if (customers < 1 || customers > MAX_CUSTOMERS) {
+          printf("[!] Invalid customer count. Use 1 to %d\n", MAX_CUSTOMERS);
+          exit(1);
+        }
+        break;
+
+      case 'd':
+        history_days = atoi(optarg);
+        if (history_days < 1) {
+          printf("[!] Invalid history length\n");
+          exit(1);
+        }
+        break;
+
+      case 'B':
+        buffer = atoi(optarg);
+        if (buffer < 0) {
+          printf("[!] Invalid buffer size\n");
+          exit(1);
+        }
+        break;
+
+      case 'm':
+        metrics = atoi(optarg);
+        if (metrics < 0) {
+          printf("[!] Invalid metrics interval\n");
+          exit(1);
+        }
+        break;
+
+      case 'M':
+        metrics_socket = optarg;
+        break;
+
       default:
         usage(pname);
     }
@@ -78,7 +220,7 @@ int main(int argc, char *argv[])
     eflag = 1;
   }
 
-  if (port < 0)
+  if (port < 0 && (!addr || Transport::hasPort((const char *)addr)))
   {
     printf("[*] Please specify the server's port to connect\n");
     eflag = 1;
@@ -90,11 +232,44 @@ int main(int argc, char *argv[])
     exit(0);
   }
 
+  if (metrics >= 0)
+    metrics_dump(metrics);
+  if (metrics_socket && metrics_serve(metrics_socket) == FAILURE)
+  {
+    log_flush();
+    exit(1);
+  }
+
   // edge 생성 및 vector ID 설정
   edge = new Edge((const char *)addr, port);
+  edge->setHistoryFile(history);
+  edge->setHourly(hourly);
+  if (record && edge->setRecordFile(record, portable) == FAILURE)
+  {
+    log_flush();
+    exit(1);
+  }
+  if (replay && edge->setReplayFile(replay) == FAILURE)
+  {
+    log_flush();
+    exit(1);
+  }
+  if (input && edge->setInputFile(input) == FAILURE)
+  {
+    log_flush();
+    exit(1);
+  }
+  edge->setStartTime(start);
+  edge->setBatchSize(batch);
+  edge->setNumOfCustomer(customers);
+  edge->setHistoryDays(history_days);
+  edge->setBufferSize(buffer);
+  if (seeded)
+    edge->setSeed(seed);
   edge->init();
   edge->setVectorID(vector_id); // ✅ vector 설정
   edge->run();
+  delete edge;
 
 	return 0;
 }
\ No newline at end of file
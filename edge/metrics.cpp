@@ -0,0 +1,326 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "metrics.h"
+#include "logger.h"
+#include "setting.h"
+
+using namespace std;
+
+// One thread's metrics; only that thread writes it
+struct metrics_shard
+{
+  atomic<uint64_t> counters[NUM_OF_COUNTERS];
+  atomic<uint64_t> buckets[NUM_OF_TIMERS][HISTOGRAM_BUCKETS];
+  atomic<uint64_t> count[NUM_OF_TIMERS];
+  atomic<uint64_t> sum[NUM_OF_TIMERS];
+  atomic<uint64_t> max[NUM_OF_TIMERS];
+  struct metrics_shard *next;
+};
+
+static const char *counter_names[NUM_OF_COUNTERS] =
+{
+  "records", "frames", "bytes_sent", "writes"
+};
+
+static const char *timer_names[NUM_OF_TIMERS] =
+{
+  "generate", "process", "encode", "send", "ack_wait", "iteration"
+};
+
+// Shards are pushed once per thread and never freed, so a reader can walk
+// the list at any time
+static atomic<struct metrics_shard *> shards(NULL);
+static __thread struct metrics_shard *local = NULL;
+
+static struct metrics_shard *shard()
+{
+  struct metrics_shard *s;
+
+  if (local)
+    return local;
+
+  s = (struct metrics_shard *)calloc(1, sizeof(struct metrics_shard));
+  s->next = shards.load(memory_order_relaxed);
+  while (!shards.compare_exchange_weak(s->next, s, memory_order_release, memory_order_relaxed))
+    ;
+  local = s;
+  return s;
+}
+
+static inline void bump(atomic<uint64_t> *v, uint64_t n)
+{
+  v->store(v->load(memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline int bucket(uint64_t v)
+{
+  int e;
+
+  if (v < (1 << HISTOGRAM_SUB_BITS))
+    return v;
+  e = 63 - __builtin_clzll(v);
+  return ((e - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+    + ((v >> (e - HISTOGRAM_SUB_BITS)) & ((1 << HISTOGRAM_SUB_BITS) - 1));
+}
+
+// Midpoint of a bucket
+static uint64_t bucket_value(int idx)
+{
+  int e, sub;
+  uint64_t lower;
+
+  if (idx < (1 << HISTOGRAM_SUB_BITS))
+    return idx;
+  e = (idx >> HISTOGRAM_SUB_BITS) + HISTOGRAM_SUB_BITS - 1;
+  sub = idx & ((1 << HISTOGRAM_SUB_BITS) - 1);
+  lower = (uint64_t)((1 << HISTOGRAM_SUB_BITS) + sub) << (e - HISTOGRAM_SUB_BITS);
+  return lower + ((1ULL << (e - HISTOGRAM_SUB_BITS)) >> 1);
+}
+
+const char *metrics_counter_name(enum metric_counter id)
+{
+  return counter_names[id];
+}
+
+const char *metrics_timer_name(enum metric_timer id)
+{
+  return timer_names[id];
+}
+
+void metrics_add(enum metric_counter id, uint64_t n)
+{
+  bump(&shard()->counters[id], n);
+}
+
+void metrics_record(enum metric_timer id, uint64_t ns)
+{
+  struct metrics_shard *s;
+
+  s = shard();
+  bump(&s->buckets[id][bucket(ns)], 1);
+  bump(&s->count[id], 1);
+  bump(&s->sum[id], ns);
+  if (ns > s->max[id].load(memory_order_relaxed))
+    s->max[id].store(ns, memory_order_relaxed);
+}
+
+uint64_t metrics_counter(enum metric_counter id)
+{
+  struct metrics_shard *s;
+  uint64_t ret;
+
+  ret = 0;
+  for (s = shards.load(memory_order_acquire); s; s = s->next)
+    ret += s->counters[id].load(memory_order_relaxed);
+  return ret;
+}
+
+void metrics_summary(enum metric_timer id, struct histogram_summary *out)
+{
+  struct metrics_shard *s;
+  static __thread uint64_t merged[HISTOGRAM_BUCKETS];
+  uint64_t seen, rank[4], *q[4];
+  int i, k;
+
+  memset(out, 0, sizeof(*out));
+  memset(merged, 0, sizeof(merged));
+  for (s = shards.load(memory_order_acquire); s; s = s->next)
+  {
+    for (i=0; i<HISTOGRAM_BUCKETS; i++)
+      merged[i] += s->buckets[id][i].load(memory_order_relaxed);
+    out->count += s->count[id].load(memory_order_relaxed);
+    out->sum += s->sum[id].load(memory_order_relaxed);
+    if (s->max[id].load(memory_order_relaxed) > out->max)
+      out->max = s->max[id].load(memory_order_relaxed);
+  }
+  if (out->count == 0)
+    return;
+
+  // ranks of p50, p90, p99 and p99.9 (1-based)
+  rank[0] = (out->count * 500 + 999) / 1000;
+  rank[1] = (out->count * 900 + 999) / 1000;
+  rank[2] = (out->count * 990 + 999) / 1000;
+  rank[3] = (out->count * 999 + 999) / 1000;
+  q[0] = &out->p50;
+  q[1] = &out->p90;
+  q[2] = &out->p99;
+  q[3] = &out->p999;
+
+  seen = 0;
+  k = 0;
+  for (i=0; i<HISTOGRAM_BUCKETS && k<4; i++)
+  {
+    seen += merged[i];
+    while (k < 4 && seen >= rank[k] && rank[k] > 0)
+      *q[k++] = bucket_value(i) < out->max ? bucket_value(i) : out->max;
+  }
+}
+
+void metrics_reset()
+{
+  struct metrics_shard *s;
+  struct metrics_shard *next;
+
+  for (s = shards.load(memory_order_acquire); s; s = next)
+  {
+    next = s->next;
+    memset((void *)s, 0, offsetof(struct metrics_shard, next));
+  }
+}
+
+int metrics_format(char *buf, int len, bool prometheus)
+{
+  struct histogram_summary h;
+  int off, i;
+
+#define APPEND(...) \
+  do { if (off < len) off += snprintf(buf + off, len - off, __VA_ARGS__); } while (0)
+
+  off = 0;
+  if (!prometheus)
+  {
+    APPEND("[*] Metrics:");
+    for (i=0; i<NUM_OF_COUNTERS; i++)
+      APPEND(" %s=%lu", counter_names[i], (unsigned long)metrics_counter((enum metric_counter)i));
+    APPEND("\n");
+    for (i=0; i<NUM_OF_TIMERS; i++)
+    {
+      metrics_summary((enum metric_timer)i, &h);
+      if (h.count == 0)
+        continue;
+      APPEND("    %-10s n=%lu mean=%.1fus p50=%.1fus p90=%.1fus p99=%.1fus p99.9=%.1fus max=%.1fus\n",
+          timer_names[i], (unsigned long)h.count, h.sum / 1e3 / h.count, h.p50 / 1e3,
+          h.p90 / 1e3, h.p99 / 1e3, h.p999 / 1e3, h.max / 1e3);
+    }
+    return off < len ? off : len - 1;
+  }
+
+  for (i=0; i<NUM_OF_COUNTERS; i++)
+  {
+    APPEND("# TYPE edge_%s_total counter\n", counter_names[i]);
+    APPEND("edge_%s_total %lu\n", counter_names[i], (unsigned long)metrics_counter((enum metric_counter)i));
+  }
+  APPEND("# TYPE edge_stage_seconds summary\n");
+  for (i=0; i<NUM_OF_TIMERS; i++)
+  {
+    metrics_summary((enum metric_timer)i, &h);
+    APPEND("edge_stage_seconds{stage=\"%s\",quantile=\"0.5\"} %.9f\n", timer_names[i], h.p50 / 1e9);
+    APPEND("edge_stage_seconds{stage=\"%s\",quantile=\"0.9\"} %.9f\n", timer_names[i], h.p90 / 1e9);
+    APPEND("edge_stage_seconds{stage=\"%s\",quantile=\"0.99\"} %.9f\n", timer_names[i], h.p99 / 1e9);
+    APPEND("edge_stage_seconds{stage=\"%s\",quantile=\"0.999\"} %.9f\n", timer_names[i], h.p999 / 1e9);
+    APPEND("edge_stage_seconds_sum{stage=\"%s\"} %.9f\n", timer_names[i], h.sum / 1e9);
+    APPEND("edge_stage_seconds_count{stage=\"%s\"} %lu\n", timer_names[i], (unsigned long)h.count);
+  }
+  APPEND("# TYPE edge_stage_max_seconds gauge\n");
+  for (i=0; i<NUM_OF_TIMERS; i++)
+  {
+    metrics_summary((enum metric_timer)i, &h);
+    APPEND("edge_stage_max_seconds{stage=\"%s\"} %.9f\n", timer_names[i], h.max / 1e9);
+  }
+
+#undef APPEND
+  return off < len ? off : len - 1;
+}
+
+// One log record per line: a record holds at most LOG_LINE bytes
+static void dump()
+{
+  static char buf[LONG_BUFLEN];
+  char *line, *next;
+
+  metrics_format(buf, sizeof(buf), false);
+  for (line = buf; *line; line = next)
+  {
+    next = strchr(line, '\n');
+    next = next ? next + 1 : line + strlen(line);
+    LOG_INFO("%.*s", (int)(next - line), line);
+  }
+}
+
+static void *dump_main(void *arg)
+{
+  long interval = (long)arg;
+
+  for (;;)
+  {
+    sleep(interval);
+    dump();
+  }
+  return NULL;
+}
+
+void metrics_dump(int interval)
+{
+  pthread_t tid;
+
+  atexit(dump);
+  if (interval > 0 && pthread_create(&tid, NULL, dump_main, (void *)(long)interval) == 0)
+    pthread_detach(tid);
+}
+
+static void *serve_main(void *arg)
+{
+  static char body[LONG_BUFLEN];
+  char header[BUFLEN], req[BUFLEN];
+  int sock, fd, len, hlen;
+
+  sock = (int)(long)arg;
+  for (;;)
+  {
+    fd = accept(sock, NULL, NULL);
+    if (fd < 0)
+      continue;
+
+    // the request itself does not matter
+    if (read(fd, req, sizeof(req)) < 0)
+      req[0] = 0;
+    len = metrics_format(body, sizeof(body), true);
+    hlen = snprintf(header, sizeof(header),
+        "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\n\r\n", len);
+    if (write(fd, header, hlen) == hlen)
+      if (write(fd, body, len) != len)
+        LOG_WARN("[!] Short write on the metrics socket\n");
+    close(fd);
+  }
+  return NULL;
+}
+
+int metrics_serve(const char *path)
+{
+  struct sockaddr_un addr;
+  pthread_t tid;
+  int sock;
+
+  if (strlen(path) >= sizeof(addr.sun_path))
+    return FAILURE;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  unlink(path);
+
+  sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(sock, 8) < 0)
+  {
+    LOG_ERROR("[*] Error: cannot serve the metrics on %s\n", path);
+    if (sock >= 0)
+      close(sock);
+    return FAILURE;
+  }
+
+  if (pthread_create(&tid, NULL, serve_main, (void *)(long)sock) != 0)
+  {
+    close(sock);
+    return FAILURE;
+  }
+  pthread_detach(tid);
+  LOG_INFO("[*] Metrics served on %s\n", path);
+  return SUCCESS;
+}
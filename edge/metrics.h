@@ -0,0 +1,104 @@
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include <cstdint>
+#include <ctime>
+
+// Hot-path counters and latency histograms. Every thread writes its own
+// shard with plain (relaxed) stores, so recording takes no lock and no
+// atomic read-modify-write; readers sum the shards. Building with
+// -DEDGE_METRICS=0 (make METRICS=0) compiles every probe out
+
+#ifndef EDGE_METRICS
+#define EDGE_METRICS 1
+#endif
+
+enum metric_counter
+{
+  COUNTER_RECORDS,        // days processed
+  COUNTER_FRAMES,         // frames sent
+  COUNTER_BYTES_SENT,
+  COUNTER_WRITES,         // write() calls
+  NUM_OF_COUNTERS
+};
+
+enum metric_timer
+{
+  TIMER_GENERATE,         // DataReceiver::getDataSet
+  TIMER_PROCESS,          // ProcessManager aggregation and features
+  TIMER_ENCODE,           // vector encoding
+  TIMER_SEND,             // NetworkManager::sendData / sendBatch
+  TIMER_ACK_WAIT,         // NetworkManager::receiveCommand
+  TIMER_ITERATION,        // one Edge::run iteration
+  NUM_OF_TIMERS
+};
+
+// Log-linear (HDR-style) buckets: values below 16 ns exactly, then 16
+// sub-buckets per power of two, i.e. at most 6.25% relative error
+#define HISTOGRAM_SUB_BITS 4
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+
+struct histogram_summary
+{
+  uint64_t count;
+  uint64_t sum;           // ns
+  uint64_t max;           // ns
+  uint64_t p50, p90, p99, p999;
+};
+
+const char *metrics_counter_name(enum metric_counter id);
+const char *metrics_timer_name(enum metric_timer id);
+
+void metrics_add(enum metric_counter id, uint64_t n);
+void metrics_record(enum metric_timer id, uint64_t ns);
+
+// Sums of all threads
+uint64_t metrics_counter(enum metric_counter id);
+void metrics_summary(enum metric_timer id, struct histogram_summary *out);
+// Zeroes every shard; only while no other thread records (benchmarks)
+void metrics_reset();
+
+// Writes the metrics as text (human: one line per timer; prometheus: the
+// text exposition format); returns the length
+int metrics_format(char *buf, int len, bool prometheus);
+
+// Logs the summary every 'interval' seconds (0: only at exit) and at exit
+void metrics_dump(int interval);
+// Serves the Prometheus text on a Unix socket (HTTP/1.0 on every connection)
+int metrics_serve(const char *path);
+
+static inline uint64_t metrics_now()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#if EDGE_METRICS
+// Times the rest of the enclosing scope
+class MetricScope
+{
+  private:
+    enum metric_timer id;
+    uint64_t start;
+
+  public:
+    MetricScope(enum metric_timer id) : id(id), start(metrics_now()) {}
+    ~MetricScope() { metrics_record(this->id, metrics_now() - this->start); }
+};
+
+#define METRIC_CAT2(a, b) a##b
+#define METRIC_CAT(a, b) METRIC_CAT2(a, b)
+#define METRIC_SCOPE(id) MetricScope METRIC_CAT(metric_scope_, __LINE__)(id)
+#define METRIC_BEGIN(var) uint64_t var = metrics_now()
+#define METRIC_END(id, var) metrics_record(id, metrics_now() - (var))
+#define METRIC_ADD(id, n) metrics_add(id, n)
+#else
+#define METRIC_SCOPE(id) do { } while (0)
+#define METRIC_BEGIN(var) do { } while (0)
+#define METRIC_END(id, var) do { } while (0)
+#define METRIC_ADD(id, n) do { } while (0)
+#endif
+
+#endif /* __METRICS_H__ */
@@ -1,29 +1,38 @@
 #include "network_manager.h"
-#include <iostream>
 #include <cstdlib>
 #include <cstring>
-#include <unistd.h>
-#include <arpa/inet.h>
-#include <sys/socket.h>
+#include <cerrno>
 #include <assert.h>
 
 #include "opcode.h"
+#include "byte_codec.h"
+#include "column_codec.h"
+#include "logger.h"
+#include "metrics.h"
 using namespace std;
 
 // Default constructor
 NetworkManager::NetworkManager() 
 {
-  this->sock = -1; // Initializing socket
+  this->transport = NULL; // Chosen by init()
   this->addr = NULL; // Initializing address pointer
   this->port = -1; // Initializing port
+  this->buffer = 0; // System default socket buffers
 }
 
 // Constructor (receiving address & port)
 NetworkManager::NetworkManager(const char *addr, int port)
 {
-  this->sock = -1; // Initializing socket
+  this->transport = NULL; // Chosen by init()
   this->addr = addr; // Setting server address
   this->port = port; // Setting server port
+  this->buffer = 0; // System default socket buffers
+}
+
+// Closing the connection
+NetworkManager::~NetworkManager()
+{
+  delete this->transport;
 }
 
 // Setting server address
@@ -50,80 +59,113 @@ int NetworkManager::getPort()
   return this->port;
 }
 
-// Initializing socket & connecting to server
-int NetworkManager::init()
+// Setting socket buffer size
+void NetworkManager::setBufferSize(int bytes)
 {
-	struct sockaddr_in serv_addr; // Structing server address
-
-    // Creating TCP socket
-	this->sock = socket(PF_INET, SOCK_STREAM, 0);
-	if (this->sock == FAILURE) // FAILURE assumed to be -1
-  {
-    cout << "[*] Error: socket() error" << endl;
-    cout << "[*] Please try again" << endl;
-    exit(1); // Terminate program when failure
-  }
-
-    // Initializing address structure with 0
-	memset(&serv_addr, 0, sizeof(serv_addr));
-	serv_addr.sin_family = AF_INET; // IPv4
-	serv_addr.sin_addr.s_addr = inet_addr(this->addr); // Converting string IP to binary
-	serv_addr.sin_port = htons(this->port); // Converting port to network byte order
+  this->buffer = bytes;
+}
 
-    // Connect to the server
-	if (connect(this->sock, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) == FAILURE)
+// Choosing the transport & connecting to server
+int NetworkManager::init()
+{
+  this->transport = Transport::create(this->addr);
+  if (this->transport->open(this->addr, this->port, this->buffer) == FAILURE)
   {
-    cout << "[*] Error: connect() error" << endl;
-    cout << "[*] Please try again" << endl;
+    LOG_ERROR("[*] Please try again\n");
+    log_flush();
     exit(1); // Terminate program when failure
   }
 
-  // Print connection success message
-  cout << "[*] Connected to " << this->addr << ":" << this->port << endl;
-
-  return sock; // Return connected socket
+  return SUCCESS;
 }
 
 // Send data to the server with vector_id and opcode
 int NetworkManager::sendData(uint8_t *data, int dlen, uint8_t vector_id)
 {
-  int sock = this->sock;
+  METRIC_SCOPE(TIMER_SEND);
 
   // Calculating total packet size
   int total_len = 1 + 1 + dlen;  // opcode + vector_id + data
-  uint8_t *buf = new uint8_t[total_len]; // Allocating buffer for full packet
+
+  // The frame buffer is kept across calls
+  if (this->frame.size() < (size_t)total_len)
+    this->frame.resize(total_len);
+  uint8_t *buf = this->frame.data();
 
   buf[0] = OPCODE_DATA;     // 1 byte
   buf[1] = vector_id;       // 1 byte
   memcpy(buf + 2, data, dlen);  // dlen: 8, 12, or 20
 
+  this->writeAll(buf, total_len);
+  return 0; // Return if success
+}
+
+// Send a batch of vectors; the float columns are converted to big-endian
+// in one bulk pass
+int NetworkManager::sendBatch(const float *values, int count, int dim, uint8_t vector_id)
+{
+  METRIC_SCOPE(TIMER_SEND);
+  size_t n = (size_t)count * dim;
+  size_t total_len = 4 + 4 * n;  // opcode + vector_id + count + data
+
+  if (count < 1 || count > BATCH_MAX)
+    return FAILURE;
+
+  if (this->frame.size() < total_len)
+    this->frame.resize(total_len);
+  uint8_t *buf = this->frame.data();
+
+  buf[0] = OPCODE_BATCH;
+  buf[1] = vector_id;
+  put_be16(buf + 2, count);
+  encode_be_f32_column(buf + 4, values, n);
+
+  this->writeAll(buf, total_len);
+  return 0;
+}
+
+// Write loop to send a full buffer
+void NetworkManager::writeAll(const uint8_t *buf, int len)
+{
   int offset = 0;
-  // Write loop to send full buffer
-  while (offset < total_len) {
-    int sent = write(sock, buf + offset, total_len - offset); // Try to send remaining bytes
+
+  while (offset < len) {
+    int sent = this->transport->write(buf + offset, len - offset); // Try to send remaining bytes
+    METRIC_ADD(COUNTER_WRITES, 1);
     if (sent > 0)
       offset += sent; // Advance offset by amount actually sent
+    else if (sent < 0 && errno != EINTR)
+    {
+      LOG_ERROR("[*] Error: the connection to the server is lost\n");
+      log_flush();
+      exit(1); // Terminate program when failure
+    }
   }
+  METRIC_ADD(COUNTER_FRAMES, 1);
+  METRIC_ADD(COUNTER_BYTES_SENT, len);
 
-  assert(offset == total_len); // Ensuring full packet being sent
-  delete[] buf; // Free allocated memory
-  return 0; // Return if success
+  assert(offset == len); // Ensuring full packet being sent
 }
 
 // TODO: Please revise or implement this function as you want. You can also remove this function if it is not needed
 // Receive command opcode from server
 uint8_t NetworkManager::receiveCommand() 
 {
-  int sock;
   uint8_t opcode;
-  uint8_t *p;
 
-  sock = this->sock;
+  METRIC_SCOPE(TIMER_ACK_WAIT);
   opcode = OPCODE_WAIT; // Initialize with wait opcode
 
   // Keep reading until valid command is received
   while (opcode == OPCODE_WAIT)
-    read(sock, &opcode, 1); // Read one byte
+  {
+    if (this->transport->read(&opcode, 1) <= 0) // Read one byte
+    {
+      LOG_ERROR("[*] Error: the server closed the connection\n");
+      log_flush();
+      exit(1); // Terminate program when failure
+    }
+  }
 
   // Ensure opcode is one of the expected values
   assert(opcode == OPCODE_DONE || opcode == OPCODE_QUIT) ;
@@ -2,28 +2,41 @@
 #define __NETWORK_MANAGER_H__
 
 #include <cstdint>
+#include <vector>
 #include "setting.h"
+#include "transport.h"
 
 class NetworkManager {
   private:
-    int sock;
+    Transport *transport;
     const char *addr;
     int port;
-    uint8_t wbuf[BUFLEN];
-    uint8_t rbuf[BUFLEN];
+    int buffer;
+    std::vector<uint8_t> frame;
+
+    void writeAll(const uint8_t *buf, int len);
 
   public:
     NetworkManager();
     NetworkManager(const char *addr, int port);
+    ~NetworkManager();
 
+    // The syntax picks the transport (see transport.h): a TCP address or
+    // host name, "unix:PATH" or "shm:/NAME"
     void setAddress(const char *addr);
     const char *getAddress();
 
     void setPort(int port);
     int getPort();
 
+    // Socket send/receive buffer size in bytes (set before init(); 0 keeps
+    // the system default)
+    void setBufferSize(int bytes);
+
     int init();
     int sendData(uint8_t *data, int dlen, uint8_t vector_id);
+    // Sends 'count' vectors of 'dim' floats as one OPCODE_BATCH frame
+    int sendBatch(const float *values, int count, int dim, uint8_t vector_id);
     uint8_t receiveCommand();
 };
 
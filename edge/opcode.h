@@ -5,5 +5,10 @@
 #define OPCODE_WAIT 2
 #define OPCODE_DONE 3
 #define OPCODE_QUIT 4
+#define OPCODE_BATCH 5
+
+// An OPCODE_BATCH frame carries up to BATCH_MAX vectors of one vector id:
+//   opcode (1) || vector_id (1) || count (2) || count * dim big-endian floats
+#define BATCH_MAX 65535
 
 #endif /* __OPCODE_H__ */
@@ -1,9 +1,11 @@
 #include "process_manager.h"
 #include "opcode.h"
-#include "byte_op.h"
+#include "vector_layout.h"
+#include "data/calendar.h"
 #include "setting.h"
+#include "logger.h"
+#include "metrics.h"
 #include <cstring>
-#include <iostream>
 #include <ctime>
 #include <cmath>
 using namespace std;
@@ -12,6 +14,27 @@ ProcessManager::ProcessManager()
 {
   this->num = 0;
   this->vector_id = 2; 
+  this->peak = 0;
+  this->load_factor = 0;
+  memset(this->hour_avg, 0, sizeof(this->hour_avg));
+  memset(this->window, 0, sizeof(this->window));
+  this->sum_short = 0;
+  this->sum_long = 0;
+  this->alpha = 0.3;
+  this->ewma = 0;
+  this->houses = 0;
+  this->house_min = NULL;
+  this->house_max = NULL;
+  this->house_ewma = NULL;
+  this->house_min_sum = 0;
+  this->house_max_sum = 0;
+}
+
+ProcessManager::~ProcessManager()
+{
+  delete[] this->house_min;
+  delete[] this->house_max;
+  delete[] this->house_ewma;
 }
 
 void ProcessManager::init()
@@ -23,77 +46,269 @@ void ProcessManager::setVectorID(int id)
   this->vector_id = id;
 }
 
-// Processes dataset information and returns a serialized byte buffer according to vector_id(0, 1, 2)
-uint8_t *ProcessManager::processData(DataSet *ds, int *dlen)
+float ProcessManager::getPeak()
 {
-  uint8_t *ret = (uint8_t *)malloc(BUFLEN);  // Allocate memory for output buffer
-  memset(ret, 0, BUFLEN);                    // Initialize buffer to zero
-  *dlen = 0;                                 // Initialize data length to zero
-  uint8_t *p = ret;                          // Pointer to the current write position in the buffer
+  return this->peak;
+}
+
+float ProcessManager::getLoadFactor()
+{
+  return this->load_factor;
+}
+
+float ProcessManager::getHourlyAverage(int hour)
+{
+  if (hour < 0 || hour >= 24)
+    return 0;
+  return this->hour_avg[hour];
+}
+
+int ProcessManager::getNumOfDays()
+{
+  return this->num;
+}
+
+void ProcessManager::setEwmaAlpha(double alpha)
+{
+  this->alpha = alpha;
+}
+
+// Average of the daily average power over the last 'days' days (7 or 30)
+float ProcessManager::getMovingAverage(int days)
+{
+  int n;
+  double sum;
+
+  sum = (days == WINDOW_SHORT) ? this->sum_short : this->sum_long;
+  n = (days == WINDOW_SHORT) ? WINDOW_SHORT : WINDOW_LONG;
+  if (this->num < n)
+    n = this->num;
+  return n > 0 ? sum / n : 0;
+}
+
+float ProcessManager::getEwma()
+{
+  return this->ewma;
+}
+
+float ProcessManager::getHouseMin(int index)
+{
+  if (index < 0 || index >= this->houses)
+    return 0;
+  return this->house_min[index];
+}
+
+float ProcessManager::getHouseMax(int index)
+{
+  if (index < 0 || index >= this->houses)
+    return 0;
+  return this->house_max[index];
+}
+
+float ProcessManager::getHouseEwma(int index)
+{
+  if (index < 0 || index >= this->houses)
+    return 0;
+  return this->house_ewma[index];
+}
+
+// Pushes today's average power into the windows: the values leaving the
+// 7-day and 30-day windows are subtracted, so no history is rescanned
+void ProcessManager::updateRolling(float avg_power)
+{
+  int head;
+
+  head = this->num % WINDOW_LONG;
+  if (this->num >= WINDOW_SHORT)
+    this->sum_short -= this->window[(this->num - WINDOW_SHORT) % WINDOW_LONG];
+  if (this->num >= WINDOW_LONG)
+    this->sum_long -= this->window[head];
+
+  this->window[head] = avg_power;
+  this->sum_short += avg_power;
+  this->sum_long += avg_power;
+
+  if (this->num == 0)
+    this->ewma = avg_power;
+  else
+    this->ewma = this->alpha * avg_power + (1 - this->alpha) * this->ewma;
+
+  this->num++;
+}
+
+// Rolls one day's power column (num > 0 houses) into the per-house and
+// day-level state; returns the day's average power
+float ProcessManager::aggregate(float *column, int num, int hours)
+{
+  double power_sum = 0.0;
+  double hour_sum[24] = { 0.0 };
+
+  // Per-house state is (re)seeded whenever the customer count changes; the
+  // day-level windows and EWMA carry on
+  bool first = false;
+  if (this->houses != num) {
+    delete[] this->house_min;
+    delete[] this->house_max;
+    delete[] this->house_ewma;
+    this->houses = num;
+    this->house_min = new float[num];
+    this->house_max = new float[num];
+    this->house_ewma = new float[num];
+    this->house_min_sum = 0;
+    this->house_max_sum = 0;
+    first = true;
+  }
+
+  // Single pass over the power column: per-hour sums, the total, and the
+  // per-house running min/max/ewma of the daily consumption
+  for (int i = 0; i < num; ++i) {
+    float *row = column + i * hours;
+    float daily = 0;
+    for (int h = 0; h < hours; ++h) {
+      hour_sum[h] += row[h];
+      daily += row[h];
+    }
+
+    if (first) {
+      this->house_min[i] = daily;
+      this->house_max[i] = daily;
+      this->house_ewma[i] = daily;
+      this->house_min_sum += daily;
+      this->house_max_sum += daily;
+    } else {
+      if (daily < this->house_min[i]) {
+        this->house_min_sum += daily - this->house_min[i];
+        this->house_min[i] = daily;
+      }
+      if (daily > this->house_max[i]) {
+        this->house_max_sum += daily - this->house_max[i];
+        this->house_max[i] = daily;
+      }
+      this->house_ewma[i] = this->alpha * daily + (1 - this->alpha) * this->house_ewma[i];
+    }
+  }
+  for (int h = 0; h < hours; ++h)
+    power_sum += hour_sum[h];
+
+  // Compute average power consumption (daily total per house)
+  float avg_power = power_sum / num;
+
+  // Per-hour averages, daily peak (largest per-hour average) and load factor
+  this->peak = 0;
+  for (int h = 0; h < hours; ++h) {
+    this->hour_avg[h] = hour_sum[h] / num;
+    if (this->hour_avg[h] > this->peak)
+      this->peak = this->hour_avg[h];
+  }
+  this->load_factor = (this->peak > 0) ? (avg_power / hours) / this->peak : 0;
+
+  // Roll today into the windows
+  this->updateRolling(avg_power);
+  return avg_power;
+}
+
+// Aggregates one DataSet, rolls it into the running state and fills every
+// feature of the day, indexed by enum feature
+void ProcessManager::computeFeatures(DataSet *ds, float *features)
+{
+  METRIC_SCOPE(TIMER_PROCESS);
 
   // Retrieve temperature and humidity data from the dataset
   TemperatureData *tdata = ds->getTemperatureData();
   HumidityData *hdata = ds->getHumidityData();
 
-  // Get the number of house entries in the dataset
+  // Get the number of house entries in the dataset and the readings per house
   int num = ds->getNumHouseData();
+  int hours = ds->getNumHours();
+  float *column = ds->getPowerColumn();
 
-  // Declare timestamp and time structure
-  time_t ts;
-  struct tm *tm;
+  // Local calendar date of the dataset's timestamp
+  struct civil_date date;
   float month, year;
 
-  ts = ds->getTimestamp();              // Get the dataset's timestamp
-  tm = localtime(&ts);                  // Convert timestamp to local time (struct tm)
-  month = tm->tm_mon + 1;               // Extract month (tm_mon is 0-based, so add 1)
-  year = tm->tm_year + 1900;            // Extract year (tm_year is years since 1900)
+  date = localDate(ds->getTimestamp()); // Convert timestamp to the local date (see data/calendar.h)
+  month = date.month;                   // Month (1 - 12)
+  year = date.year;                     // Year
 
   float max_temp = tdata->getMax();     // Retrieve max temperature from temperature data
   float max_humid = hdata->getMax();    // Retrieve max humidity from humidity data
   float avg_humid = hdata->getValue();  // Retrieve average humidity
 
-  // Initialize power and humidity sums
-  float power_sum = 0.0;                
-  float humidity_sum = 0.0;
+  // Debug output of month and year
+  LOG_DEBUG("month: %f, year: %f\n", month, year);
 
-   // Debug output of month and year
-  printf("month: %f, year: %f\n", month, year);
+  // A day without meters (possible with CSV input) keeps the power
+  // features and the rolling state of the last day
+  float avg_power;
+  if (num > 0)
+    avg_power = this->aggregate(column, num, hours);
+  else
+    avg_power = this->num > 0 ? this->window[(this->num - 1) % WINDOW_LONG] : 0;
 
-  // Sum power consumption across all houses
-  for (int i = 0; i < num; ++i) {
-    HouseData *house = ds->getHouseData(i);
-    PowerData *pdata = house->getPowerData();
-    power_sum += pdata->getValue();
-  }
-  
-  // Compute average power consumption
-  float avg_power = power_sum / num;
+  features[FEATURE_DISCOMFORT] = 0.81 * max_temp + 0.01 * avg_humid * (0.99 * max_temp - 14.3) + 46.3;
+  features[FEATURE_MAX_TEMP] = max_temp;
+  features[FEATURE_AVG_HUMID] = avg_humid;
+  features[FEATURE_MAX_HUMID] = max_humid;
+  features[FEATURE_MONTH] = month;
+  features[FEATURE_YEAR] = year;
+  features[FEATURE_PEAK] = this->peak;
+  features[FEATURE_LOAD_FACTOR] = this->load_factor;
+  features[FEATURE_MA_SHORT] = this->getMovingAverage(WINDOW_SHORT);
+  features[FEATURE_MA_LONG] = this->getMovingAverage(WINDOW_LONG);
+  features[FEATURE_EWMA] = this->ewma;
+  features[FEATURE_HOUSE_MIN_AVG] = this->houses > 0 ? this->house_min_sum / this->houses : 0;
+  features[FEATURE_HOUSE_MAX_AVG] = this->houses > 0 ? this->house_max_sum / this->houses : 0;
+  features[FEATURE_AVG_POWER] = avg_power;
+}
 
-  // === Branch based on vector ID ===
-  if (vector_id == 2) {
-    // [max_humid, max_temp, month, year, avg_power]
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&max_humid), p); *dlen += 4;
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&max_temp), p);  *dlen += 4;
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&month), p);     *dlen += 4;
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&year), p);      *dlen += 4;
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&avg_power), p); *dlen += 4;
-
-  } else if (vector_id == 1) {
-    // [max_temp, avg_humid, avg_power]
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&max_temp), p);   *dlen += 4;
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&avg_humid), p);  *dlen += 4;
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&avg_power), p);  *dlen += 4;
-
-  } else if (vector_id == 0) {
-    // [discomfort_index, avg_power]
-    float discomfort = 0.81 * max_temp + 0.01 * avg_humid * (0.99 * max_temp - 14.3) + 46.3;
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&discomfort), p); *dlen += 4;
-    VAR_TO_MEM_4BYTES_BIG_ENDIAN(*((uint32_t *)&avg_power), p);  *dlen += 4;
-
-  } else {
-    // Invalid vector ID; print warning
-    cout << "[!] Unknown vector ID: " << vector_id << endl;
-  }
-  // Return the serialized byte buffer
+// Processes dataset information and returns a serialized byte buffer according to vector_id
+// (one of vector_table in vector_layout.h); the caller frees it
+uint8_t *ProcessManager::processData(DataSet *ds, int *dlen)
+{
+  uint8_t *ret = (uint8_t *)malloc(BUFLEN);  // Allocate memory for output buffer
+  memset(ret, 0, BUFLEN);                    // Initialize buffer to zero
+  *dlen = this->processData(ds, ret);
   return ret;
-}
\ No newline at end of file
+}
+
+// Same as above, but serializes into 'buf' (at least BUFLEN bytes) and
+// returns the length; no allocation
+int ProcessManager::processData(DataSet *ds, uint8_t *buf)
+{
+  float features[NUM_OF_FEATURES];
+  int dlen = 0;
+
+  this->computeFeatures(ds, features);
+
+  // Serialize with the encoder of the vector layout (see vector_layout.h)
+  METRIC_BEGIN(t0);
+  if (vector_id >= 0 && vector_id < NUM_OF_VECTORS)
+    dlen = vector_table[vector_id].encode(features, buf);
+  else
+    LOG_WARN("[!] Unknown vector ID: %d\n", vector_id);
+  METRIC_END(TIMER_ENCODE, t0);
+
+  return dlen;
+}
+
+// Same as processData(), but leaves the vector as native floats in 'vec'
+// (for batching); returns the dimension
+int ProcessManager::processVector(DataSet *ds, float *vec)
+{
+  float features[NUM_OF_FEATURES];
+  const struct vector_info *v;
+
+  this->computeFeatures(ds, features);
+
+  if (vector_id < 0 || vector_id >= NUM_OF_VECTORS)
+  {
+    LOG_WARN("[!] Unknown vector ID: %d\n", vector_id);
+    return 0;
+  }
+
+  METRIC_SCOPE(TIMER_ENCODE);
+  v = &vector_table[vector_id];
+  for (int i = 0; i < v->dim; ++i)
+    vec[i] = features[v->fields[i]];
+  return v->dim;
+}
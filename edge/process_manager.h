@@ -4,17 +4,58 @@
 #include "data/dataset.h"
 #include <cstdint>
 
+#define WINDOW_SHORT 7
+#define WINDOW_LONG 30
+
 class ProcessManager {
 private:
     int num;
     int vector_id;
+    float peak;
+    float load_factor;
+    float hour_avg[24];
+
+    // Rolling state across days, updated in O(1) per day (O(1) per house
+    // for the per-house state)
+    float window[WINDOW_LONG];   // ring of the last daily average powers
+    double sum_short;
+    double sum_long;
+    double alpha;
+    double ewma;
+    int houses;
+    float *house_min;
+    float *house_max;
+    float *house_ewma;
+    double house_min_sum;
+    double house_max_sum;
+
+    void updateRolling(float avg_power);
+    float aggregate(float *column, int num, int hours);
+    void computeFeatures(DataSet *ds, float *features);
 
 public:
     ProcessManager();
+    ~ProcessManager();
     void init();
 
     void setVectorID(int id);
     uint8_t *processData(DataSet *ds, int *dlen);
+    int processData(DataSet *ds, uint8_t *buf);
+    int processVector(DataSet *ds, float *vec);
+
+    // Load-profile aggregates of the last processed DataSet
+    float getPeak();
+    float getLoadFactor();
+    float getHourlyAverage(int hour);
+
+    // Rolling aggregates over all processed days
+    int getNumOfDays();
+    void setEwmaAlpha(double alpha);
+    float getMovingAverage(int days);
+    float getEwma();
+    float getHouseMin(int index);
+    float getHouseMax(int index);
+    float getHouseEwma(int index);
 };
 
 #endif /* __PROCESS_MANAGER_H__ */
\ No newline at end of file
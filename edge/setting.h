@@ -1,7 +1,14 @@
 #ifndef __SETTING_H__
 #define __SETTING_H__
 
+// Defaults; the customer count, the history length, the batch size and
+// the socket buffer size are set at run time (see edge -h)
 #define NUM_OF_CUSTOMER 1000
+#define HISTORY_DAYS 365
+// Customer indexes and column offsets (customers * 24) stay within an int
+#define MAX_CUSTOMERS 50000000
+
+// Fixed scratch sizes (one encoded vector, one log line, ...)
 #define BUFLEN 1024
 #define LONG_BUFLEN 65535
 
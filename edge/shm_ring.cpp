@@ -0,0 +1,329 @@
+#include "shm_ring.h"
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "logger.h"
+#include "setting.h"
+
+#define SHM_MAGIC 0x45444752        // "EDGR"
+#define SHM_SPIN 2000               // polls before sleeping (multi-core only)
+
+static long futex(std::atomic<uint32_t> *word, int op, uint32_t val, const struct timespec *ts)
+{
+  return syscall(SYS_futex, (uint32_t *)word, op, val, ts, NULL, 0);
+}
+
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+// Waits until *word differs from 'observed'; false on timeout. The other
+// side stores the word before it checks the flag, this side sets the flag
+// before it checks the word (both seq_cst), so one of them always sees
+// the other and no wake-up is lost
+static bool wait_change(std::atomic<uint32_t> *word, std::atomic<uint32_t> *flag,
+    uint32_t observed, int timeout_ms)
+{
+  static const bool spin = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+  struct timespec ts;
+
+  if (spin)
+  {
+    for (int i=0; i<SHM_SPIN; i++)
+    {
+      if (word->load(std::memory_order_acquire) != observed)
+        return true;
+      cpu_relax();
+    }
+  }
+
+  ts.tv_sec = timeout_ms / 1000;
+  ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000;
+
+  flag->store(1);
+  if (word->load() == observed)
+    futex(word, FUTEX_WAIT, observed, timeout_ms < 0 ? NULL : &ts);
+  flag->store(0, std::memory_order_relaxed);
+  return word->load(std::memory_order_acquire) != observed;
+}
+
+static void wake(std::atomic<uint32_t> *word, std::atomic<uint32_t> *flag)
+{
+  if (flag->load())
+    futex(word, FUTEX_WAKE, 1, NULL);
+}
+
+ShmRing::ShmRing()
+{
+  this->name = NULL;
+  this->seg = NULL;
+  this->tx = NULL;
+  this->rx = NULL;
+  this->owner = false;
+}
+
+ShmRing::~ShmRing()
+{
+  if (this->seg)
+  {
+    if (!this->owner)
+    {
+      this->seg->state.store(SHM_DETACHED);
+      futex(&this->seg->frames.head, FUTEX_WAKE, 1, NULL);
+    }
+    else
+    {
+      // an attached edge stops waiting for acks or for room
+      this->seg->state.store(SHM_CLOSED);
+      futex(&this->seg->acks.head, FUTEX_WAKE, 1, NULL);
+      futex(&this->seg->frames.tail, FUTEX_WAKE, 1, NULL);
+    }
+    munmap(this->seg, this->seg->length);
+  }
+  if (this->owner)
+    shm_unlink(this->name);
+  free(this->name);
+}
+
+uint8_t *ShmRing::data(struct shm_channel *ch)
+{
+  return (uint8_t *)this->seg + ch->offset;
+}
+
+static bool process_alive(int32_t pid)
+{
+  return pid > 0 && !(kill(pid, 0) < 0 && errno == ESRCH);
+}
+
+// The edge checks the collector, the collector the attached edge
+bool ShmRing::peerAlive()
+{
+  if (this->owner)
+    return this->getState() == SHM_ATTACHED;
+  return this->seg->state.load() != SHM_CLOSED && process_alive(this->seg->owner.load());
+}
+
+int ShmRing::create(const char *name, uint32_t size)
+{
+  uint32_t length;
+  int fd;
+
+  if (size == 0 || (size & (size - 1)))
+  {
+    LOG_ERROR("[*] Error: the ring size must be a power of two\n");
+    return FAILURE;
+  }
+  length = sizeof(struct shm_segment) + SHM_ACK_SIZE + size;
+
+  // a segment left behind by a collector that died is replaced
+  shm_unlink(name);
+  fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0 || ftruncate(fd, length) < 0)
+  {
+    LOG_ERROR("[*] Error: cannot create the shared memory segment %s\n", name);
+    if (fd >= 0)
+      close(fd);
+    return FAILURE;
+  }
+  this->seg = (struct shm_segment *)mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (this->seg == MAP_FAILED)
+  {
+    this->seg = NULL;
+    shm_unlink(name);
+    return FAILURE;
+  }
+
+  // ftruncate zero-fills: the counters, flags and state start at 0
+  this->seg->length = length;
+  this->seg->acks.size = SHM_ACK_SIZE;
+  this->seg->acks.offset = sizeof(struct shm_segment);
+  this->seg->frames.size = size;
+  this->seg->frames.offset = sizeof(struct shm_segment) + SHM_ACK_SIZE;
+  this->seg->owner.store(getpid(), std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  this->seg->magic = SHM_MAGIC;
+
+  this->name = strdup(name);
+  this->owner = true;
+  this->tx = &this->seg->acks;
+  this->rx = &this->seg->frames;
+  return SUCCESS;
+}
+
+static bool power_of_two(uint32_t v)
+{
+  return v != 0 && (v & (v - 1)) == 0;
+}
+
+// The layout create() writes, checked against the mapped size: both rings
+// lie inside the mapping, in order, with power-of-two sizes
+static bool valid_layout(struct shm_segment *seg, size_t size)
+{
+  uint64_t frames_end;
+
+  frames_end = (uint64_t)seg->frames.offset + seg->frames.size;
+  return seg->length == size
+    && power_of_two(seg->acks.size) && power_of_two(seg->frames.size)
+    && seg->acks.offset == sizeof(struct shm_segment)
+    && seg->frames.offset == (uint64_t)seg->acks.offset + seg->acks.size
+    && frames_end == seg->length;
+}
+
+int ShmRing::attach(const char *name)
+{
+  struct stat st;
+  uint32_t state = SHM_FREE;
+  int fd;
+
+  fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0 || fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(struct shm_segment))
+  {
+    LOG_ERROR("[*] Error: no collector serves the shared memory segment %s\n", name);
+    if (fd >= 0)
+      close(fd);
+    return FAILURE;
+  }
+  this->seg = (struct shm_segment *)mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (this->seg == MAP_FAILED)
+  {
+    this->seg = NULL;
+    return FAILURE;
+  }
+
+  if (this->seg->magic != SHM_MAGIC || !process_alive(this->seg->owner.load()))
+  {
+    LOG_ERROR("[*] Error: no collector serves the shared memory segment %s\n", name);
+    munmap(this->seg, st.st_size);
+    this->seg = NULL;
+    return FAILURE;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (!valid_layout(this->seg, st.st_size))
+  {
+    LOG_ERROR("[*] Error: the shared memory segment %s has an invalid layout\n", name);
+    munmap(this->seg, st.st_size);
+    this->seg = NULL;
+    return FAILURE;
+  }
+  if (!this->seg->state.compare_exchange_strong(state, SHM_ATTACHED))
+  {
+    LOG_ERROR("[*] Error: the shared memory segment %s is in use\n", name);
+    munmap(this->seg, st.st_size);
+    this->seg = NULL;
+    return FAILURE;
+  }
+
+  this->seg->pid.store(getpid());
+  this->name = strdup(name);
+  this->tx = &this->seg->frames;
+  this->rx = &this->seg->acks;
+  return SUCCESS;
+}
+
+int ShmRing::write(const uint8_t *buf, size_t len)
+{
+  struct shm_channel *ch = this->tx;
+  uint8_t *d = this->data(ch);
+  uint32_t head, room, n, off, first;
+
+  while (len > 0)
+  {
+    head = ch->head.load(std::memory_order_relaxed);
+    room = ch->size - (head - ch->tail.load(std::memory_order_acquire));
+    if (room == 0)
+    {
+      if (!wait_change(&ch->tail, &ch->writer_waiting, head - ch->size, SHM_POLL_MS) && !this->peerAlive())
+        return FAILURE;
+      continue;
+    }
+
+    n = len < room ? len : room;
+    off = head & (ch->size - 1);
+    first = n < ch->size - off ? n : ch->size - off;
+    memcpy(d + off, buf, first);
+    memcpy(d, buf + first, n - first);
+
+    ch->head.store(head + n);
+    wake(&ch->head, &ch->reader_waiting);
+    buf += n;
+    len -= n;
+  }
+  return SUCCESS;
+}
+
+size_t ShmRing::read(uint8_t *buf, size_t len, int timeout_ms)
+{
+  struct shm_channel *ch = this->rx;
+  uint8_t *d = this->data(ch);
+  uint32_t head, tail, n, off, first;
+
+  tail = ch->tail.load(std::memory_order_relaxed);
+  while ((head = ch->head.load(std::memory_order_acquire)) == tail)
+  {
+    if (timeout_ms >= 0)
+    {
+      if (!wait_change(&ch->head, &ch->reader_waiting, tail, timeout_ms))
+        return 0;
+    }
+    else if (!wait_change(&ch->head, &ch->reader_waiting, tail, SHM_POLL_MS) && !this->peerAlive())
+    {
+      // the last bytes the peer wrote before it left are still read
+      if (ch->head.load(std::memory_order_acquire) == tail)
+        return 0;
+    }
+  }
+
+  n = head - tail;
+  if (n > len)
+    n = len;
+  off = tail & (ch->size - 1);
+  first = n < ch->size - off ? n : ch->size - off;
+  memcpy(buf, d + off, first);
+  memcpy(buf + first, d, n - first);
+
+  ch->tail.store(tail + n);
+  wake(&ch->tail, &ch->writer_waiting);
+  return n;
+}
+
+uint32_t ShmRing::getState()
+{
+  uint32_t state = this->seg->state.load(std::memory_order_acquire);
+  int32_t pid = this->seg->pid.load();
+
+  if (state == SHM_ATTACHED && pid > 0 && !process_alive(pid))
+  {
+    this->seg->state.compare_exchange_strong(state, SHM_DETACHED);
+    return SHM_DETACHED;
+  }
+  return state;
+}
+
+void ShmRing::reset()
+{
+  struct shm_channel *chs[] = { &this->seg->frames, &this->seg->acks };
+
+  for (struct shm_channel *ch : chs)
+  {
+    ch->head.store(0, std::memory_order_relaxed);
+    ch->tail.store(0, std::memory_order_relaxed);
+    ch->reader_waiting.store(0, std::memory_order_relaxed);
+    ch->writer_waiting.store(0, std::memory_order_relaxed);
+  }
+  this->seg->pid.store(0, std::memory_order_relaxed);
+  this->seg->state.store(SHM_FREE, std::memory_order_release);
+}
@@ -0,0 +1,82 @@
+#ifndef __SHM_RING_H__
+#define __SHM_RING_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Shared-memory byte stream between an edge and a collector on the same
+// host, carrying the same frames and acks as the TCP connection. The
+// collector creates the segment (shm_open), one edge at a time attaches
+// to it. A segment holds two single-producer single-consumer rings,
+// frames (edge -> collector) and acks (collector -> edge); a side that
+// finds its ring full or empty spins briefly, then sleeps on a futex
+// that the other side wakes only when the sleeper flagged itself. The
+// sleeps are bounded, so a side notices when its peer is gone (closed,
+// or its process died) instead of waiting for it forever
+
+#define SHM_RING_SIZE (1 << 20)     // frame ring bytes (power of two)
+#define SHM_ACK_SIZE 4096           // ack ring bytes (power of two)
+#define SHM_POLL_MS 100             // longest sleep between peer checks
+
+// Attach state of a segment
+#define SHM_FREE 0
+#define SHM_ATTACHED 1
+#define SHM_DETACHED 2              // the edge left; the collector resets
+#define SHM_CLOSED 3                // the collector left
+
+struct shm_channel
+{
+  alignas(64) std::atomic<uint32_t> head;         // bytes written
+  std::atomic<uint32_t> reader_waiting;
+  alignas(64) std::atomic<uint32_t> tail;         // bytes read
+  std::atomic<uint32_t> writer_waiting;
+  alignas(64) uint32_t size;
+  uint32_t offset;                                // of the data from the segment
+};
+
+struct shm_segment
+{
+  uint32_t magic;
+  uint32_t length;                                // of the whole mapping
+  std::atomic<uint32_t> state;
+  std::atomic<int32_t> pid;                       // of the attached edge
+  std::atomic<int32_t> owner;                     // pid of the collector
+  struct shm_channel frames;
+  struct shm_channel acks;
+};
+
+class ShmRing
+{
+  private:
+    char *name;
+    struct shm_segment *seg;
+    struct shm_channel *tx;
+    struct shm_channel *rx;
+    bool owner;
+
+    uint8_t *data(struct shm_channel *ch);
+    bool peerAlive();
+
+  public:
+    ShmRing();
+    ~ShmRing();
+
+    // Collector side: creates (or recreates) the segment
+    int create(const char *name, uint32_t size);
+    // Edge side: attaches to a free segment
+    int attach(const char *name);
+
+    // Writes all of buf, waiting for room; FAILURE once the peer is gone
+    int write(const uint8_t *buf, size_t len);
+    // Waits up to timeout_ms (-1: as long as the peer is there) for data;
+    // returns the bytes read, 0 on timeout or once the peer is gone
+    size_t read(uint8_t *buf, size_t len, int timeout_ms);
+
+    // Collector side; an edge that died attached counts as detached
+    uint32_t getState();
+    // Empties both rings and frees the segment for the next edge
+    void reset();
+};
+
+#endif /* __SHM_RING_H__ */
@@ -0,0 +1,87 @@
+#include <cstddef>
+#include <new>
+#include "alloc_track.h"
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *p, size_t size);
+void __libc_free(void *p);
+}
+
+// initial-exec TLS: no allocation on first access from inside malloc
+static __thread struct alloc_stats stats __attribute__((tls_model("initial-exec")));
+
+struct alloc_stats alloc_thread_stats()
+{
+  return stats;
+}
+
+// The sanitizers bring their own allocator; the counts stay zero there
+#ifndef __SANITIZE_ADDRESS__
+bool alloc_tracking()
+{
+  return true;
+}
+
+extern "C" void *malloc(size_t size)
+{
+  stats.count++;
+  stats.bytes += size;
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t n, size_t size)
+{
+  stats.count++;
+  stats.bytes += n * size;
+  return __libc_calloc(n, size);
+}
+
+extern "C" void *realloc(void *p, size_t size)
+{
+  stats.count++;
+  stats.bytes += size;
+  return __libc_realloc(p, size);
+}
+
+extern "C" void free(void *p)
+{
+  if (p)
+    stats.frees++;
+  __libc_free(p);
+}
+
+// operator new/delete are replaced too, so the counts do not depend on
+// how the C++ runtime implements them
+static void *track_new(size_t size)
+{
+  void *p;
+
+  stats.count++;
+  stats.bytes += size;
+  p = __libc_malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+static void track_delete(void *p)
+{
+  if (p)
+    stats.frees++;
+  __libc_free(p);
+}
+
+void *operator new(size_t size) { return track_new(size); }
+void *operator new[](size_t size) { return track_new(size); }
+void operator delete(void *p) noexcept { track_delete(p); }
+void operator delete[](void *p) noexcept { track_delete(p); }
+void operator delete(void *p, size_t) noexcept { track_delete(p); }
+void operator delete[](void *p, size_t) noexcept { track_delete(p); }
+#else
+bool alloc_tracking()
+{
+  return false;
+}
+#endif
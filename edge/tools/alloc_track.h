@@ -0,0 +1,44 @@
+#ifndef __ALLOC_TRACK_H__
+#define __ALLOC_TRACK_H__
+
+#include <cstdint>
+
+// Opt-in heap allocation tracker for tests and benchmarks; it is not part
+// of libedge. Linking alloc_track.o replaces malloc/calloc/realloc/free
+// and operator new/delete with counting wrappers around glibc's allocator.
+// Counts are per thread, so a measured thread is not disturbed by helpers
+// (e.g., a loopback server) running next to it
+struct alloc_stats
+{
+  uint64_t count;   // malloc, calloc, realloc and operator new calls
+  uint64_t bytes;   // bytes requested
+  uint64_t frees;   // free and operator delete calls (non-NULL)
+};
+
+// False when the tracker is compiled out (sanitizer builds bring their
+// own allocator); every count then stays zero
+bool alloc_tracking();
+
+struct alloc_stats alloc_thread_stats();
+
+// Adds the allocations made while it lives to 'total'; for per-component
+// accounting
+class AllocScope
+{
+  private:
+    struct alloc_stats *total;
+    struct alloc_stats start;
+
+  public:
+    AllocScope(struct alloc_stats *total) : total(total), start(alloc_thread_stats()) {}
+    ~AllocScope()
+    {
+      struct alloc_stats end = alloc_thread_stats();
+
+      this->total->count += end.count - this->start.count;
+      this->total->bytes += end.bytes - this->start.bytes;
+      this->total->frees += end.frees - this->start.frees;
+    }
+};
+
+#endif /* __ALLOC_TRACK_H__ */
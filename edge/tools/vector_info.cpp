@@ -0,0 +1,23 @@
+#include <cstdio>
+#include "../vector_layout.h"
+
+// Prints the vector table of vector_layout.h as JSON; the Makefile writes
+// it to server/vector_info.json, which server.py loads as VECTOR_INFO
+int main()
+{
+  int i, j;
+  const struct vector_info *v;
+
+  printf("{\n");
+  for (i=0; i<NUM_OF_VECTORS; i++)
+  {
+    v = &vector_table[i];
+    printf("  \"%d\": {\"dim\": %d, \"index\": %d, \"fields\": [", i, v->dim, v->index);
+    for (j=0; j<v->dim; j++)
+      printf("%s\"%s\"", j ? ", " : "", feature_names[v->fields[j]]);
+    printf("]}%s\n", i + 1 < NUM_OF_VECTORS ? "," : "");
+  }
+  printf("}\n");
+
+  return 0;
+}
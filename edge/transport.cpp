@@ -0,0 +1,192 @@
+#include "transport.h"
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <unistd.h>
+#include <netdb.h>
+
+#include "logger.h"
+#include "setting.h"
+
+#define SHM_PREFIX "shm:"
+#define UNIX_PREFIX "unix:"
+
+static bool has_prefix(const char *addr, const char *prefix)
+{
+  return !strncmp(addr, prefix, strlen(prefix));
+}
+
+Transport *Transport::create(const char *addr)
+{
+  if (has_prefix(addr, SHM_PREFIX))
+    return new ShmTransport();
+  if (has_prefix(addr, UNIX_PREFIX) || addr[0] == '/')
+    return new UnixTransport();
+  return new TcpTransport();
+}
+
+bool Transport::hasPort(const char *addr)
+{
+  return !has_prefix(addr, SHM_PREFIX) && !has_prefix(addr, UNIX_PREFIX) && addr[0] != '/';
+}
+
+// ====== SocketTransport ======
+SocketTransport::SocketTransport()
+{
+  this->sock = -1;
+}
+
+SocketTransport::~SocketTransport()
+{
+  if (this->sock >= 0)
+    close(this->sock);
+}
+
+// Large batch frames go out in fewer writes with a larger send buffer
+void SocketTransport::setBuffer(int buffer)
+{
+  if (buffer > 0)
+  {
+    setsockopt(this->sock, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+    setsockopt(this->sock, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+  }
+}
+
+int SocketTransport::write(const uint8_t *buf, int len)
+{
+  return ::write(this->sock, buf, len);
+}
+
+int SocketTransport::read(uint8_t *buf, int len)
+{
+  return ::read(this->sock, buf, len);
+}
+
+// ====== TcpTransport ======
+// Tries every address the name resolves to (IPv4 and IPv6) in order
+int TcpTransport::open(const char *addr, int port, int buffer)
+{
+  struct addrinfo hints, *res, *ai;
+  char host[BUFLEN], service[16];
+  size_t len;
+  int err;
+
+  // [v6 address]
+  len = strlen(addr);
+  if (len >= 2 && addr[0] == '[' && addr[len - 1] == ']' && len - 2 < sizeof(host))
+    snprintf(host, sizeof(host), "%.*s", (int)len - 2, addr + 1);
+  else
+    snprintf(host, sizeof(host), "%s", addr);
+  snprintf(service, sizeof(service), "%d", port);
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  err = getaddrinfo(host, service, &hints, &res);
+  if (err)
+  {
+    LOG_ERROR("[*] Error: cannot resolve %s (%s)\n", host, gai_strerror(err));
+    return FAILURE;
+  }
+
+  for (ai = res; ai; ai = ai->ai_next)
+  {
+    this->sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (this->sock < 0)
+      continue;
+    this->setBuffer(buffer);
+    if (connect(this->sock, ai->ai_addr, ai->ai_addrlen) == 0)
+      break;
+    close(this->sock);
+    this->sock = -1;
+  }
+  freeaddrinfo(res);
+
+  if (this->sock < 0)
+  {
+    LOG_ERROR("[*] Error: connect() error\n");
+    return FAILURE;
+  }
+
+  LOG_INFO("[*] Connected to %s:%d\n", addr, port);
+  return SUCCESS;
+}
+
+// ====== UnixTransport ======
+int UnixTransport::address(const char *path, struct sockaddr_un *sun, socklen_t *len)
+{
+  size_t n = strlen(path);
+
+  memset(sun, 0, sizeof(*sun));
+  sun->sun_family = AF_UNIX;
+  if (n == 0 || n >= sizeof(sun->sun_path))
+  {
+    LOG_ERROR("[*] Error: invalid socket path %s\n", path);
+    return FAILURE;
+  }
+  memcpy(sun->sun_path, path, n);
+  *len = offsetof(struct sockaddr_un, sun_path) + n;
+  if (path[0] == '@')
+    sun->sun_path[0] = '\0';   // abstract namespace
+  else
+    (*len)++;
+  return SUCCESS;
+}
+
+// The port does not apply
+int UnixTransport::open(const char *addr, int port, int buffer)
+{
+  struct sockaddr_un sun;
+  const char *path = has_prefix(addr, UNIX_PREFIX) ? addr + strlen(UNIX_PREFIX) : addr;
+  socklen_t len;
+
+  (void)port;
+  if (UnixTransport::address(path, &sun, &len) == FAILURE)
+    return FAILURE;
+
+  this->sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (this->sock < 0)
+  {
+    LOG_ERROR("[*] Error: socket() error\n");
+    return FAILURE;
+  }
+  this->setBuffer(buffer);
+
+  if (connect(this->sock, (struct sockaddr *)&sun, len) < 0)
+  {
+    LOG_ERROR("[*] Error: connect() error\n");
+    return FAILURE;
+  }
+
+  LOG_INFO("[*] Connected to %s\n", path);
+  return SUCCESS;
+}
+
+// ====== ShmTransport ======
+// The collector serves the segment; the port and the socket buffer size
+// do not apply
+int ShmTransport::open(const char *addr, int port, int buffer)
+{
+  const char *name = addr + strlen(SHM_PREFIX);
+
+  (void)port;
+  (void)buffer;
+  if (this->ring.attach(name) == FAILURE)
+    return FAILURE;
+
+  LOG_INFO("[*] Attached to the shared memory ring %s\n", name);
+  return SUCCESS;
+}
+
+int ShmTransport::write(const uint8_t *buf, int len)
+{
+  if (this->ring.write(buf, len) == FAILURE)
+    return FAILURE;
+  return len;
+}
+
+// 0 once the collector is gone
+int ShmTransport::read(uint8_t *buf, int len)
+{
+  return this->ring.read(buf, len, -1);
+}
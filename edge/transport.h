@@ -0,0 +1,75 @@
+#ifndef __TRANSPORT_H__
+#define __TRANSPORT_H__
+
+#include <cstdint>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "shm_ring.h"
+
+// Byte stream between the edge and the server; NetworkManager builds the
+// frames and picks the transport from the address:
+//
+//   shm:/NAME         shared-memory ring of a collector on the same host
+//   unix:PATH, /PATH  Unix domain stream socket (unix:@NAME: abstract)
+//   otherwise         TCP to ADDR:PORT; ADDR is an IPv4 or IPv6 address
+//                     (optionally in brackets) or a host name
+class Transport
+{
+  public:
+    virtual ~Transport() {}
+
+    // 'buffer': socket buffer size in bytes, 0 keeps the system default
+    virtual int open(const char *addr, int port, int buffer) = 0;
+    // Bytes written (at least 1), or FAILURE
+    virtual int write(const uint8_t *buf, int len) = 0;
+    // Blocks for at least 1 byte; 0 once the peer is gone
+    virtual int read(uint8_t *buf, int len) = 0;
+
+    static Transport *create(const char *addr);
+    // Whether the address needs a port (TCP)
+    static bool hasPort(const char *addr);
+};
+
+class SocketTransport : public Transport
+{
+  protected:
+    int sock;
+
+    void setBuffer(int buffer);
+
+  public:
+    SocketTransport();
+    ~SocketTransport();
+
+    int write(const uint8_t *buf, int len) override;
+    int read(uint8_t *buf, int len) override;
+};
+
+class TcpTransport : public SocketTransport
+{
+  public:
+    int open(const char *addr, int port, int buffer) override;
+};
+
+class UnixTransport : public SocketTransport
+{
+  public:
+    int open(const char *addr, int port, int buffer) override;
+
+    // Fills the socket address of a path ("@NAME": abstract namespace);
+    // shared with the collector's listener
+    static int address(const char *path, struct sockaddr_un *sun, socklen_t *len);
+};
+
+class ShmTransport : public Transport
+{
+  private:
+    ShmRing ring;
+
+  public:
+    int open(const char *addr, int port, int buffer) override;
+    int write(const uint8_t *buf, int len) override;
+    int read(uint8_t *buf, int len) override;
+};
+
+#endif /* __TRANSPORT_H__ */
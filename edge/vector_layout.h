@@ -0,0 +1,100 @@
+#ifndef __VECTOR_LAYOUT_H__
+#define __VECTOR_LAYOUT_H__
+
+#include <cstdint>
+#include "byte_codec.h"
+
+// Every value a feature vector can carry; ProcessManager computes all of
+// them once per DataSet into a float array indexed by this enum
+enum feature
+{
+  FEATURE_DISCOMFORT,
+  FEATURE_MAX_TEMP,
+  FEATURE_AVG_HUMID,
+  FEATURE_MAX_HUMID,
+  FEATURE_MONTH,
+  FEATURE_YEAR,
+  FEATURE_PEAK,
+  FEATURE_LOAD_FACTOR,
+  FEATURE_MA_SHORT,
+  FEATURE_MA_LONG,
+  FEATURE_EWMA,
+  FEATURE_HOUSE_MIN_AVG,
+  FEATURE_HOUSE_MAX_AVG,
+  FEATURE_AVG_POWER,
+  NUM_OF_FEATURES
+};
+
+// Names used in the generated server/vector_info.json
+constexpr const char *feature_names[NUM_OF_FEATURES] =
+{
+  "discomfort", "max_temp", "avg_humid", "max_humid", "month", "year",
+  "peak", "load_factor", "ma7", "ma30", "ewma", "house_min_avg",
+  "house_max_avg", "avg_power"
+};
+
+// What the edge and the server need to know about one vector id: the
+// dimension, the position of the label (avg_power) that the model
+// predicts, the field list and the encoder
+struct vector_info
+{
+  int dim;
+  int index;
+  const enum feature *fields;
+  int (*encode)(const float *features, uint8_t *p);
+};
+
+// A vector layout as a compile-time field list. The encoder is unrolled
+// over the fields, so the size and the big-endian byte order are fixed at
+// compile time and the generated code is a sequence of stores
+template <enum feature... F>
+struct VectorLayout
+{
+  static constexpr int dim = sizeof...(F);
+  static constexpr int size = dim * 4;
+  static constexpr enum feature fields[] = { F... };
+
+  static constexpr int label()
+  {
+    for (int i=0; i<dim; i++)
+      if (fields[i] == FEATURE_AVG_POWER)
+        return i;
+    return -1;
+  }
+
+  static int encode(const float *features, uint8_t *p)
+  {
+    int i = 0;
+
+    ((put_be_f32(p + 4 * i++, features[F])), ...);
+    return size;
+  }
+
+  static constexpr struct vector_info info = { dim, label(), fields, encode };
+
+  static_assert(label() >= 0, "a vector layout must carry avg_power");
+};
+
+// The vector ids, in order; adding a vector id is one line here
+constexpr struct vector_info vector_table[] =
+{
+  // 0: 2D [discomfort, avg_power]
+  VectorLayout<FEATURE_DISCOMFORT, FEATURE_AVG_POWER>::info,
+  // 1: 3D [max_temp, avg_humid, avg_power]
+  VectorLayout<FEATURE_MAX_TEMP, FEATURE_AVG_HUMID, FEATURE_AVG_POWER>::info,
+  // 2: 5D [max_humid, max_temp, month, year, avg_power]
+  VectorLayout<FEATURE_MAX_HUMID, FEATURE_MAX_TEMP, FEATURE_MONTH, FEATURE_YEAR,
+    FEATURE_AVG_POWER>::info,
+  // 3: 5D load profile [max_temp, avg_humid, peak, load_factor, avg_power]
+  VectorLayout<FEATURE_MAX_TEMP, FEATURE_AVG_HUMID, FEATURE_PEAK, FEATURE_LOAD_FACTOR,
+    FEATURE_AVG_POWER>::info,
+  // 4: 4D rolling [ma7, ma30, ewma, avg_power]
+  VectorLayout<FEATURE_MA_SHORT, FEATURE_MA_LONG, FEATURE_EWMA, FEATURE_AVG_POWER>::info,
+  // 5: 4D per-house extremes [house_min_avg, house_max_avg, ewma, avg_power]
+  VectorLayout<FEATURE_HOUSE_MIN_AVG, FEATURE_HOUSE_MAX_AVG, FEATURE_EWMA,
+    FEATURE_AVG_POWER>::info,
+};
+
+#define NUM_OF_VECTORS ((int)(sizeof(vector_table) / sizeof(vector_table[0])))
+
+#endif /* __VECTOR_LAYOUT_H__ */
@@ -0,0 +1,548 @@
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "collector.h"
+#include "../../edge/opcode.h"
+#include "../../edge/byte_codec.h"
+#include "../../edge/column_codec.h"
+#include "../../edge/vector_layout.h"
+#include "../../edge/logger.h"
+#include "../../edge/setting.h"
+#include "../../edge/transport.h"
+
+using namespace std;
+
+#define EVENTS 256
+#define READ_CHUNK 65536
+
+// Per-connection state; the input buffer holds at most one partial frame
+// past what was consumed
+struct connection
+{
+  int fd;
+  vector<uint8_t> in;
+  size_t head;              // first byte not consumed
+  size_t tail;              // end of the received bytes
+  string out;               // acks not written yet
+  long received;            // vectors
+  bool closing;             // OPCODE_QUIT queued
+  bool want_out;            // registered for EPOLLOUT
+  bool listener;            // a listening socket, not a connection
+};
+
+// Makes room past the received bytes
+static void make_room(struct connection *c)
+{
+  if (c->tail < c->in.size())
+    return;
+  if (c->head > 0)
+  {
+    memmove(c->in.data(), c->in.data() + c->head, c->tail - c->head);
+    c->tail -= c->head;
+    c->head = 0;
+  }
+  else
+    c->in.resize(c->in.size() + READ_CHUNK);
+}
+
+static void reset(struct connection *c)
+{
+  c->listener = false;
+  c->head = c->tail = 0;
+  c->out.clear();
+  c->received = 0;
+  c->closing = false;
+  c->want_out = false;
+}
+
+Collector::Collector(const char *addr, int port)
+{
+  this->addr = addr;
+  this->port = port;
+  this->unix_path = NULL;
+  this->unix_sock = -1;
+  this->threads = 1;
+  this->ntrain = 10;
+  this->ntest = 10;
+  this->sink = NULL;
+  this->running = false;
+  memset((void *)&this->stats, 0, sizeof(this->stats));
+}
+
+Collector::~Collector()
+{
+  for (int fd : this->listeners)
+    close(fd);
+  for (ShmRing *ring : this->rings)
+    delete ring;
+  if (this->unix_sock >= 0)
+  {
+    close(this->unix_sock);
+    if (this->unix_path[0] != '@')
+      unlink(this->unix_path);
+  }
+}
+
+void Collector::setThreads(int threads)
+{
+  this->threads = threads;
+}
+
+void Collector::setRecords(long ntrain, long ntest)
+{
+  this->ntrain = ntrain;
+  this->ntest = ntest;
+}
+
+void Collector::setSink(Sink *sink)
+{
+  this->sink = sink;
+}
+
+void Collector::setUnixSocket(const char *path)
+{
+  this->unix_path = path;
+}
+
+void Collector::addShm(const char *name)
+{
+  this->shm_names.push_back(name);
+}
+
+const struct collector_stats *Collector::getStats()
+{
+  return &this->stats;
+}
+
+int Collector::init()
+{
+  struct addrinfo hints, *res;
+  struct sockaddr_un sun;
+  struct stat st;
+  socklen_t len;
+  char service[16];
+  int sock, err, one = 1;
+
+  for (const char *name : this->shm_names)
+  {
+    ShmRing *ring = new ShmRing();
+    if (ring->create(name, SHM_RING_SIZE) == FAILURE)
+    {
+      delete ring;
+      return FAILURE;
+    }
+    this->rings.push_back(ring);
+    LOG_INFO("[*] Collector is serving the shared memory ring %s\n", name);
+  }
+
+  if (this->unix_path)
+  {
+    if (UnixTransport::address(this->unix_path, &sun, &len) == FAILURE)
+      return FAILURE;
+    // a socket left behind by a collector that died is replaced
+    if (this->unix_path[0] != '@' && stat(this->unix_path, &st) == 0 && S_ISSOCK(st.st_mode))
+      unlink(this->unix_path);
+
+    this->unix_sock = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (this->unix_sock < 0 || bind(this->unix_sock, (struct sockaddr *)&sun, len) < 0
+        || listen(this->unix_sock, SOMAXCONN) < 0)
+    {
+      LOG_ERROR("[*] Error: cannot listen on %s (%s)\n", this->unix_path, strerror(errno));
+      if (this->unix_sock >= 0)
+        close(this->unix_sock);
+      this->unix_sock = -1;
+      return FAILURE;
+    }
+    LOG_INFO("[*] Collector is listening on %s\n", this->unix_path);
+  }
+
+  if (this->port < 0)
+    return SUCCESS;
+
+  // IPv4 or IPv6 (a v6 socket also takes v4 clients unless bindv6only)
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  snprintf(service, sizeof(service), "%d", this->port);
+  err = getaddrinfo(this->addr, service, &hints, &res);
+  if (err)
+  {
+    LOG_ERROR("[*] Error: invalid address %s (%s)\n", this->addr, gai_strerror(err));
+    return FAILURE;
+  }
+
+  for (int i=0; i<this->threads; i++)
+  {
+    sock = socket(res->ai_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (sock < 0)
+      break;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    if (bind(sock, res->ai_addr, res->ai_addrlen) < 0 || listen(sock, SOMAXCONN) < 0)
+    {
+      close(sock);
+      break;
+    }
+    this->listeners.push_back(sock);
+  }
+  freeaddrinfo(res);
+
+  if ((int)this->listeners.size() < this->threads)
+  {
+    LOG_ERROR("[*] Error: cannot listen on %s:%d (%s)\n", this->addr, this->port, strerror(errno));
+    return FAILURE;
+  }
+
+  LOG_INFO("[*] Collector is listening on %s:%d with %d loop(s)\n", this->addr, this->port, this->threads);
+  return SUCCESS;
+}
+
+void Collector::run()
+{
+  this->running = true;
+  if (!this->listeners.empty() || this->unix_sock >= 0)
+    for (int i=0; i<this->threads; i++)
+      this->loops.emplace_back(&Collector::loop, this, this->listeners.empty() ? -1 : this->listeners[i]);
+  for (ShmRing *ring : this->rings)
+    this->loops.emplace_back(&Collector::shmLoop, this, ring);
+  for (auto &t : this->loops)
+    t.join();
+  this->loops.clear();
+}
+
+void Collector::stop()
+{
+  this->running = false;
+}
+
+// 'lsock': this loop's TCP listener, or -1
+void Collector::loop(int lsock)
+{
+  struct epoll_event ev, events[EVENTS];
+  struct connection *c, listeners[2];
+  vector<float> values;
+  int epfd, n;
+  bool alive;
+
+  epfd = epoll_create1(0);
+  listeners[0].fd = lsock;
+  listeners[1].fd = this->unix_sock;
+  for (struct connection &l : listeners)
+  {
+    if (l.fd < 0)
+      continue;
+    l.listener = true;
+    // the Unix socket is shared: wake one loop per connection
+    ev.events = EPOLLIN | (l.fd == this->unix_sock ? EPOLLEXCLUSIVE : 0);
+    ev.data.ptr = &l;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, l.fd, &ev);
+  }
+
+  while (this->running)
+  {
+    // the timeout bounds how long stop() takes
+    n = epoll_wait(epfd, events, EVENTS, 200);
+    for (int i=0; i<n; i++)
+    {
+      c = (struct connection *)events[i].data.ptr;
+      if (c->listener)
+      {
+        this->accept(epfd, c->fd);
+        continue;
+      }
+
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+      {
+        // the frames that arrived with the EOF are still consumed
+        alive = this->receive(c);
+        if (!this->consume(c, &values) || !alive)
+        {
+          this->drop(epfd, c);
+          continue;
+        }
+      }
+      if (!this->flush(epfd, c))
+        this->drop(epfd, c);
+    }
+  }
+  close(epfd);
+}
+
+// One edge at a time: the session starts with its first bytes and ends
+// when the edge detaches (after OPCODE_QUIT, or when it exits). Acks are
+// not written after a bad frame or once the edge is gone, as nobody would
+// read them
+void Collector::shmLoop(ShmRing *ring)
+{
+  struct connection c;
+  vector<float> values;
+  bool active = false, broken = false, detached;
+  size_t n;
+
+  c.fd = -1;
+  reset(&c);
+  while (this->running)
+  {
+    detached = ring->getState() == SHM_DETACHED;
+
+    make_room(&c);
+    // drain what a detached edge left without waiting
+    n = ring->read(c.in.data() + c.tail, c.in.size() - c.tail, detached ? 0 : 200);
+    if (n > 0)
+    {
+      if (!active)
+      {
+        active = true;
+        this->stats.connections.fetch_add(1, memory_order_relaxed);
+        this->stats.active.fetch_add(1, memory_order_relaxed);
+        if (this->ntrain == 0 && this->ntest > 0)
+          this->sink->train();
+      }
+      this->stats.bytes.fetch_add(n, memory_order_relaxed);
+
+      c.tail += n;
+      if (broken || !this->consume(&c, &values))
+      {
+        broken = true;
+        c.head = c.tail = 0;
+      }
+      if (!c.out.empty() && !broken && !detached)
+        ring->write((const uint8_t *)c.out.data(), c.out.size());
+      c.out.clear();
+      continue;
+    }
+
+    if (detached)
+    {
+      if (active)
+        this->stats.active.fetch_sub(1, memory_order_relaxed);
+      active = broken = false;
+      reset(&c);
+      ring->reset();
+    }
+  }
+}
+
+void Collector::accept(int epfd, int lsock)
+{
+  struct epoll_event ev;
+  struct connection *c;
+  int fd, one = 1;
+
+  while ((fd = accept4(lsock, NULL, NULL, SOCK_NONBLOCK)) >= 0)
+  {
+    // the edge waits for every ack, so it must not sit in Nagle's buffer
+    // (fails harmlessly on Unix sockets)
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    c = new connection();
+    c->fd = fd;
+    reset(c);
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = c;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+
+    this->stats.connections.fetch_add(1, memory_order_relaxed);
+    this->stats.active.fetch_add(1, memory_order_relaxed);
+
+    // as server.py: without training data the models are trained up front
+    if (this->ntrain == 0 && this->ntest > 0)
+      this->sink->train();
+  }
+}
+
+// Reads whatever is available; false when the peer is gone (the bytes
+// read before are kept)
+bool Collector::receive(struct connection *c)
+{
+  ssize_t n;
+
+  for (;;)
+  {
+    make_room(c);
+    n = read(c->fd, c->in.data() + c->tail, c->in.size() - c->tail);
+    if (n > 0)
+    {
+      c->tail += n;
+      this->stats.bytes.fetch_add(n, memory_order_relaxed);
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return true;
+    if (n < 0 && errno == EINTR)
+      continue;
+    return false;
+  }
+}
+
+// Hands the vectors to the sink, split at the end of the training data
+// and cut at the end of the session
+void Collector::deliver(struct connection *c, int vector_id, const float *values, int count, int dim)
+{
+  long total, train;
+
+  total = this->ntrain + this->ntest;
+  if (total > 0 && c->received + count > total)
+    count = total - c->received;
+
+  train = 0;
+  if (c->received < this->ntrain)
+    train = min<long>(count, this->ntrain - c->received);
+
+  if (train > 0)
+  {
+    this->sink->put(vector_id, values, train, dim, true);
+    if (c->received + train == this->ntrain)
+      this->sink->train();
+  }
+  if (count > train)
+    this->sink->put(vector_id, values + train * dim, count - train, dim, total == 0 || c->received + train < this->ntrain);
+
+  c->received += count;
+  this->stats.vectors.fetch_add(count, memory_order_relaxed);
+}
+
+// Decodes every complete frame and queues one ack per frame; false on a
+// malformed frame
+bool Collector::consume(struct connection *c, vector<float> *values)
+{
+  const uint8_t *p;
+  size_t avail, need, hdr;
+  int count, dim, vector_id;
+  long total;
+
+  total = this->ntrain + this->ntest;
+  while (!c->closing)
+  {
+    p = c->in.data() + c->head;
+    avail = c->tail - c->head;
+    if (avail < 2)
+      break;
+
+    if (p[0] == OPCODE_DATA)
+    {
+      count = 1;
+      hdr = 2;
+    }
+    else if (p[0] == OPCODE_BATCH)
+    {
+      if (avail < 4)
+        break;
+      count = get_be16(p + 2);
+      hdr = 4;
+    }
+    else
+    {
+      LOG_WARN("[!] Invalid opcode: %d\n", p[0]);
+      this->stats.errors.fetch_add(1, memory_order_relaxed);
+      return false;
+    }
+
+    vector_id = p[1];
+    if (vector_id >= NUM_OF_VECTORS || count == 0)
+    {
+      LOG_WARN("[!] Invalid frame: vector %d, count %d\n", vector_id, count);
+      this->stats.errors.fetch_add(1, memory_order_relaxed);
+      return false;
+    }
+    dim = vector_table[vector_id].dim;
+    need = hdr + (size_t)count * dim * 4;
+
+    if (avail < need)
+    {
+      // room for the rest of this frame
+      if (c->in.size() - c->head < need)
+      {
+        memmove(c->in.data(), p, avail);
+        c->head = 0;
+        c->tail = avail;
+        if (c->in.size() < need)
+          c->in.resize(need);
+      }
+      break;
+    }
+
+    if (values->size() < (size_t)count * dim)
+      values->resize((size_t)count * dim);
+    decode_be_f32_column(values->data(), p + hdr, (size_t)count * dim);
+    this->deliver(c, vector_id, values->data(), count, dim);
+    this->stats.frames.fetch_add(1, memory_order_relaxed);
+    c->head += need;
+
+    if (total > 0 && c->received >= total)
+    {
+      c->out.push_back(OPCODE_QUIT);
+      c->closing = true;
+      this->sink->finish();
+    }
+    else
+      c->out.push_back(OPCODE_DONE);
+  }
+
+  if (c->head == c->tail)
+    c->head = c->tail = 0;
+  return true;
+}
+
+// Switches EPOLLOUT interest, only when it changes
+static void want_out(int epfd, struct connection *c, bool on)
+{
+  struct epoll_event ev;
+
+  if (c->want_out == on)
+    return;
+  ev.events = EPOLLIN | (on ? EPOLLOUT : 0);
+  ev.data.ptr = c;
+  epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+  c->want_out = on;
+}
+
+// Writes the queued acks; waits for EPOLLOUT when the socket is full.
+// false once the connection is to be closed
+bool Collector::flush(int epfd, struct connection *c)
+{
+  ssize_t n;
+
+  while (!c->out.empty())
+  {
+    n = write(c->fd, c->out.data(), c->out.size());
+    if (n > 0)
+    {
+      c->out.erase(0, n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      want_out(epfd, c, true);
+      return true;
+    }
+    return false;
+  }
+
+  if (c->closing)
+    return false;
+
+  want_out(epfd, c, false);
+  return true;
+}
+
+void Collector::drop(int epfd, struct connection *c)
+{
+  epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+  close(c->fd);
+  delete c;
+  this->stats.active.fetch_sub(1, memory_order_relaxed);
+}
@@ -0,0 +1,86 @@
+#ifndef __COLLECTOR_H__
+#define __COLLECTOR_H__
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "sink.h"
+#include "../../edge/shm_ring.h"
+
+// Collection server for edges (the protocol of edge/opcode.h), as a
+// native counterpart of server.py for load tests. Every event loop owns
+// an epoll instance and its own SO_REUSEPORT listening socket, so the
+// kernel spreads the connections over the loops. A frame (OPCODE_DATA or
+// OPCODE_BATCH) is decoded once it is complete, handed to the sink and
+// answered with a single opcode, like server.py does. Edges on the same
+// host can also use a Unix domain socket, or a shared-memory ring
+// (edge/shm_ring.h) that is served by a thread of its own
+
+struct collector_stats
+{
+  std::atomic<uint64_t> connections;    // accepted
+  std::atomic<uint64_t> active;
+  std::atomic<uint64_t> frames;
+  std::atomic<uint64_t> vectors;
+  std::atomic<uint64_t> bytes;          // received
+  std::atomic<uint64_t> errors;         // connections dropped on a bad frame
+};
+
+struct connection;
+
+class Collector
+{
+  private:
+    const char *addr;
+    int port;
+    const char *unix_path;
+    int unix_sock;
+    int threads;
+    long ntrain;
+    long ntest;
+    Sink *sink;
+    std::atomic<bool> running;
+    std::vector<int> listeners;
+    std::vector<const char *> shm_names;
+    std::vector<ShmRing *> rings;
+    std::vector<std::thread> loops;
+    struct collector_stats stats;
+
+    void loop(int lsock);
+    void shmLoop(ShmRing *ring);
+    void accept(int epfd, int lsock);
+    bool receive(struct connection *c);
+    bool consume(struct connection *c, std::vector<float> *values);
+    void deliver(struct connection *c, int vector_id, const float *values, int count, int dim);
+    bool flush(int epfd, struct connection *c);
+    void drop(int epfd, struct connection *c);
+
+  public:
+    Collector(const char *addr, int port);
+    ~Collector();
+
+    // Event loops (default 1)
+    void setThreads(int threads);
+    // Vectors per connection used for training, then for testing; the
+    // connection is answered OPCODE_QUIT after both. 0 and 0: no limit,
+    // everything is training data
+    void setRecords(long ntrain, long ntest);
+    void setSink(Sink *sink);
+    // Also listens on a Unix domain socket ("@NAME": abstract namespace);
+    // all loops share it
+    void setUnixSocket(const char *path);
+    // Serves a shared-memory ring (one edge at a time) besides TCP; a
+    // negative port leaves TCP out
+    void addShm(const char *name);
+
+    int init();
+    // Serves until stop()
+    void run();
+    // Async-signal-safe
+    void stop();
+
+    const struct collector_stats *getStats();
+};
+
+#endif /* __COLLECTOR_H__ */
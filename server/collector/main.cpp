@@ -0,0 +1,253 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "collector.h"
+#include "sink.h"
+#include "../../edge/logger.h"
+#include "../../edge/setting.h"
+
+static Collector *collector;
+
+void usage(uint8_t *pname)
+{
+  printf(">> Usage: %s [options]\n", pname);
+  printf("Options\n");
+  printf("  -p, --lport      Port to listen on\n");
+  printf("  -s, --shm        Serve edges on this host through the shared-memory ring\n");
+  printf("                   NAME (edge -a shm:NAME); repeatable, -p is then optional\n");
+  printf("  -a, --addr       Address to listen on, IPv4 or IPv6 (default: 0.0.0.0)\n");
+  printf("  -u, --unix       Also listen on this Unix socket path (@NAME: abstract);\n");
+  printf("                   -p is then optional\n");
+  printf("  -t, --threads    Event loops (default: 1)\n");
+  printf("  -T, --ntrain     Training vectors per connection (default: 10)\n");
+  printf("  -E, --ntest      Testing vectors per connection (default: 10)\n");
+  printf("                   0 and 0 keep the connections open without a limit\n");
+  printf("  -k, --sink       Where the vectors go: none, file or http (default: none)\n");
+  printf("  -o, --output     CSV file of the file sink\n");
+  printf("  -n, --name       Model name prefix of the http sink\n");
+  printf("  -A, --algorithm  Algorithm of the http sink's models\n");
+  printf("  -c, --caddr      AI module's address (http sink)\n");
+  printf("  -C, --cport      AI module's port (http sink)\n");
+  printf("  -b, --batch      Vectors per request to the AI module (default: 64)\n");
+  printf("                   A frame is acked once its vectors are buffered in memory,\n");
+  printf("                   not once the AI module has them\n");
+  printf("  -q, --queue      Requests queued before the loops wait (default: 1024)\n");
+  printf("  -i, --interval   Log the throughput every SEC seconds (default: 0, only at exit)\n");
+  exit(0);
+}
+
+static void on_signal(int sig)
+{
+  collector->stop();
+}
+
+static void report(const struct collector_stats *s, uint64_t *last, int interval)
+{
+  uint64_t bytes = s->bytes.load(), vectors = s->vectors.load();
+
+  LOG_INFO("[*] %lu active, %lu accepted, %lu frames, %lu vectors (%.0f/s), %.1f MB (%.1f MB/s), %lu errors\n",
+      s->active.load(), s->connections.load(), s->frames.load(), vectors,
+      interval ? (double)(vectors - last[0]) / interval : 0.0,
+      bytes / 1e6, interval ? (bytes - last[1]) / 1e6 / interval : 0.0, s->errors.load());
+  last[0] = vectors;
+  last[1] = bytes;
+}
+
+int main(int argc, char *argv[])
+{
+  int c, port = -1, threads = 1, interval = 0;
+  long ntrain = 10, ntest = 10;
+  uint8_t *pname;
+  const char *addr = "0.0.0.0";
+  const char *sink_type = "none";
+  const char *output = NULL;
+  const char *name = NULL;
+  const char *algorithm = NULL;
+  const char *caddr = NULL;
+  int cport = -1;
+  int batch = 64, depth = 1024;
+  std::vector<const char *> shm;
+  const char *unix_path = NULL;
+  uint64_t last[2] = { 0, 0 };
+  Sink *sink;
+
+  pname = (uint8_t *)argv[0];
+
+  while (1)
+  {
+    int option_index = 0;
+    static struct option long_options[] = {
+      {"lport", required_argument, 0, 'p'},
+      {"shm", required_argument, 0, 's'},
+      {"addr", required_argument, 0, 'a'},
+      {"unix", required_argument, 0, 'u'},
+      {"threads", required_argument, 0, 't'},
+      {"ntrain", required_argument, 0, 'T'},
+      {"ntest", required_argument, 0, 'E'},
+      {"sink", required_argument, 0, 'k'},
+      {"output", required_argument, 0, 'o'},
+      {"name", required_argument, 0, 'n'},
+      {"algorithm", required_argument, 0, 'A'},
+      {"caddr", required_argument, 0, 'c'},
+      {"cport", required_argument, 0, 'C'},
+      {"batch", required_argument, 0, 'b'},
+      {"queue", required_argument, 0, 'q'},
+      {"interval", required_argument, 0, 'i'},
+      {0, 0, 0, 0}
+    };
+
+    const char *opt = "p:s:a:u:t:T:E:k:o:n:A:c:C:b:q:i:";
+
+    c = getopt_long(argc, argv, opt, long_options, &option_index);
+
+    if (c == -1)
+      break;
+
+    switch (c)
+    {
+      case 'p':
+        port = atoi(optarg);
+        break;
+
+      case 's':
+        shm.push_back(optarg);
+        break;
+
+      case 'a':
+        addr = optarg;
+        break;
+
+      case 'u':
+        unix_path = optarg;
+        break;
+
+      case 't':
+        threads = atoi(optarg);
+        if (threads < 1) {
+          printf("[!] Invalid number of event loops\n");
+          exit(1);
+        }
+        break;
+
+      case 'T':
+        ntrain = atol(optarg);
+        break;
+
+      case 'E':
+        ntest = atol(optarg);
+        break;
+
+      case 'k':
+        sink_type = optarg;
+        break;
+
+      case 'o':
+        output = optarg;
+        break;
+
+      case 'n':
+        name = optarg;
+        break;
+
+      case 'A':
+        algorithm = optarg;
+        break;
+
+      case 'c':
+        caddr = optarg;
+        break;
+
+      case 'C':
+        cport = atoi(optarg);
+        break;
+
+      case 'b':
+        batch = atoi(optarg);
+        if (batch < 1) {
+          printf("[!] Invalid batch size\n");
+          exit(1);
+        }
+        break;
+
+      case 'q':
+        depth = atoi(optarg);
+        if (depth < 1) {
+          printf("[!] Invalid queue depth\n");
+          exit(1);
+        }
+        break;
+
+      case 'i':
+        interval = atoi(optarg);
+        break;
+
+      default:
+        usage(pname);
+    }
+  }
+
+  if ((port < 0 && shm.empty() && !unix_path) || ntrain < 0 || ntest < 0 || interval < 0)
+    usage(pname);
+
+  if (!strcmp(sink_type, "none"))
+    sink = new NullSink();
+  else if (!strcmp(sink_type, "file") && output)
+    sink = new FileSink(output);
+  else if (!strcmp(sink_type, "http") && name && algorithm && caddr && cport > 0)
+  {
+    HttpSink *http = new HttpSink(name, algorithm, caddr, cport);
+    http->setBatch(batch, depth);
+    sink = http;
+  }
+  else
+  {
+    printf("[*] Please specify the sink: none, file with -o, or http with -n, -A, -c and -C\n");
+    usage(pname);
+  }
+
+  if (sink->init() == FAILURE)
+  {
+    log_flush();
+    exit(1);
+  }
+
+  collector = new Collector(addr, port);
+  collector->setThreads(threads);
+  collector->setRecords(ntrain, ntest);
+  collector->setSink(sink);
+  collector->setUnixSocket(unix_path);
+  for (const char *name : shm)
+    collector->addShm(name);
+  if (collector->init() == FAILURE)
+  {
+    log_flush();
+    exit(1);
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+  signal(SIGPIPE, SIG_IGN);
+
+  if (interval > 0)
+  {
+    std::thread([interval, &last]() {
+      for (;;)
+      {
+        sleep(interval);
+        report(collector->getStats(), last, interval);
+      }
+    }).detach();
+  }
+
+  collector->run();
+  report(collector->getStats(), last, 0);
+
+  delete collector;
+  delete sink;
+
+  return 0;
+}
@@ -0,0 +1,390 @@
+#include <cstring>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <strings.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "sink.h"
+#include "../../edge/vector_layout.h"
+#include "../../edge/logger.h"
+#include "../../edge/setting.h"
+
+using namespace std;
+
+#define FLUSH_MS 500
+
+// ====== NullSink ======
+void NullSink::put(int vector_id, const float *values, int count, int dim, bool training)
+{
+}
+
+// ====== FileSink ======
+FileSink::FileSink(const char *path)
+{
+  this->path = path;
+  this->fp = NULL;
+}
+
+FileSink::~FileSink()
+{
+  if (this->fp)
+    fclose(this->fp);
+}
+
+int FileSink::init()
+{
+  this->fp = fopen(this->path.c_str(), "a");
+  if (!this->fp)
+  {
+    LOG_ERROR("[*] Error: cannot open %s\n", this->path.c_str());
+    return FAILURE;
+  }
+  setvbuf(this->fp, NULL, _IOFBF, 1 << 20);
+  return SUCCESS;
+}
+
+void FileSink::put(int vector_id, const float *values, int count, int dim, bool training)
+{
+  char line[BUFLEN];
+  int len;
+
+  lock_guard<mutex> guard(this->lock);
+  for (int i=0; i<count; i++)
+  {
+    len = snprintf(line, sizeof(line), "%d,%d", vector_id, training ? 1 : 0);
+    for (int j=0; j<dim && len < (int)sizeof(line); j++)
+      len += snprintf(line + len, sizeof(line) - len, ",%.9g", values[i * dim + j]);
+    if (len < (int)sizeof(line) - 1)
+      line[len++] = '\n';
+    fwrite(line, 1, len, this->fp);
+  }
+}
+
+// ====== HttpSink ======
+HttpSink::HttpSink(const char *name, const char *algorithm, const char *addr, int port)
+{
+  this->name = name;
+  this->algorithm = algorithm;
+  this->addr = addr;
+  this->port = port;
+  this->sock = -1;
+  this->batch = 64;
+  this->depth = 1024;
+  this->running = false;
+  for (int vid=0; vid<NUM_OF_VECTORS; vid++)
+    this->counts[vid][0] = this->counts[vid][1] = 0;
+}
+
+// Sends whatever is still buffered or queued before closing
+HttpSink::~HttpSink()
+{
+  if (this->sender.joinable())
+  {
+    {
+      unique_lock<mutex> guard(this->lock);
+      this->flush(guard, false);
+      this->running = false;
+    }
+    this->not_empty.notify_one();
+    this->sender.join();
+  }
+  if (this->sock >= 0)
+    close(this->sock);
+}
+
+void HttpSink::setBatch(int batch, int depth)
+{
+  this->batch = batch;
+  this->depth = depth;
+}
+
+// The AI module's address may be IPv4, IPv6 or a host name
+int HttpSink::connect()
+{
+  struct addrinfo hints, *res, *ai;
+  char service[16];
+  int one = 1;
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  snprintf(service, sizeof(service), "%d", this->port);
+  if (getaddrinfo(this->addr.c_str(), service, &hints, &res) != 0)
+    res = NULL;
+
+  for (ai = res; ai; ai = ai->ai_next)
+  {
+    this->sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (this->sock < 0)
+      continue;
+    if (::connect(this->sock, ai->ai_addr, ai->ai_addrlen) == 0)
+      break;
+    close(this->sock);
+    this->sock = -1;
+  }
+  if (res)
+    freeaddrinfo(res);
+
+  if (this->sock < 0)
+  {
+    LOG_ERROR("[*] Error: cannot connect to the AI module at %s:%d\n", this->addr.c_str(), this->port);
+    return FAILURE;
+  }
+  setsockopt(this->sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return SUCCESS;
+}
+
+static bool write_all(int fd, const char *buf, size_t len)
+{
+  ssize_t n;
+
+  while (len > 0)
+  {
+    n = write(fd, buf, len);
+    if (n <= 0)
+      return false;
+    buf += n;
+    len -= n;
+  }
+  return true;
+}
+
+// One HTTP/1.1 exchange on the keep-alive connection; returns the status
+// code, or FAILURE. A connection the server closed in the meantime is
+// reopened once
+int HttpSink::request(const char *method, const string &path, const string &body, string *response)
+{
+  char header[BUFLEN], buf[LONG_BUFLEN];
+  string in;
+  size_t end, length, pos;
+  bool keep, has_length, v6;
+  int hlen, status;
+  ssize_t n;
+
+  v6 = this->addr.find(':') != string::npos;
+  hlen = snprintf(header, sizeof(header),
+      "%s %s HTTP/1.1\r\nHost: %s%s%s:%d\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n\r\n",
+      method, path.c_str(), v6 ? "[" : "", this->addr.c_str(), v6 ? "]" : "", this->port, body.size());
+
+  for (int attempt=0; ; attempt++)
+  {
+    if (this->sock < 0 && this->connect() == FAILURE)
+      return FAILURE;
+    if (write_all(this->sock, header, hlen) && write_all(this->sock, body.data(), body.size()))
+    {
+      n = read(this->sock, buf, sizeof(buf));
+      if (n > 0)
+      {
+        in.assign(buf, n);
+        break;
+      }
+    }
+    close(this->sock);
+    this->sock = -1;
+    if (attempt > 0)
+      return FAILURE;
+  }
+
+  // headers
+  while ((end = in.find("\r\n\r\n")) == string::npos)
+  {
+    n = read(this->sock, buf, sizeof(buf));
+    if (n <= 0)
+      break;
+    in.append(buf, n);
+  }
+  if (end == string::npos || sscanf(in.c_str(), "HTTP/1.%*d %d", &status) != 1)
+  {
+    close(this->sock);
+    this->sock = -1;
+    return FAILURE;
+  }
+
+  keep = in.compare(0, 8, "HTTP/1.1") == 0;
+  has_length = false;
+  length = 0;
+  for (pos = in.find("\r\n") + 2; pos < end; pos = in.find("\r\n", pos) + 2)
+  {
+    const char *line = in.c_str() + pos;
+
+    if (strncasecmp(line, "Content-Length:", 15) == 0)
+    {
+      length = strtoul(line + 15, NULL, 10);
+      has_length = true;
+    }
+    else if (strncasecmp(line, "Connection:", 11) == 0)
+    {
+      line += 11 + strspn(line + 11, " ");
+      if (strncasecmp(line, "keep-alive", 10) == 0)
+        keep = true;
+      else if (strncasecmp(line, "close", 5) == 0)
+        keep = false;
+    }
+  }
+
+  // body: Content-Length bytes, or up to the end of the connection
+  end += 4;
+  while (has_length ? in.size() - end < length : true)
+  {
+    n = read(this->sock, buf, sizeof(buf));
+    if (n <= 0)
+    {
+      keep = false;
+      break;
+    }
+    in.append(buf, n);
+  }
+
+  if (response)
+    response->assign(in, end, has_length ? length : string::npos);
+  if (!keep || !has_length)
+  {
+    close(this->sock);
+    this->sock = -1;
+  }
+  return status;
+}
+
+int HttpSink::init()
+{
+  char body[BUFLEN];
+  string response;
+  int status;
+
+  for (int vid=0; vid<NUM_OF_VECTORS; vid++)
+  {
+    snprintf(body, sizeof(body), "{\"algorithm\": \"%s\", \"dimension\": %d, \"index\": %d}",
+        this->algorithm.c_str(), vector_table[vid].dim, vector_table[vid].index);
+    status = this->request("POST", "/" + this->name + "_vec" + to_string(vid), body, &response);
+    if (status != 200)
+    {
+      LOG_ERROR("[!] Failed to create model %s_vec%d (status %d)\n", this->name.c_str(), vid, status);
+      return FAILURE;
+    }
+    LOG_INFO("[*] Created model: %s_vec%d\n", this->name.c_str(), vid);
+  }
+
+  this->running = true;
+  this->sender = thread(&HttpSink::send, this);
+  return SUCCESS;
+}
+
+// Callers hold the lock; 'wait' blocks while the queue is full (the
+// sender itself never waits on its own queue)
+void HttpSink::enqueue(unique_lock<mutex> &guard, struct http_request req, bool wait)
+{
+  if (wait)
+    this->not_full.wait(guard, [this] { return (int)this->queue.size() < this->depth; });
+  this->queue.push_back(move(req));
+  this->not_empty.notify_one();
+}
+
+// Queues every buffered batch. The AI module expects a JSON string
+// holding the JSON object (see server.py), so the inner quotes are escaped.
+// The wait for room comes first: the batch is taken and queued without
+// dropping the lock, so a put() from another loop cannot append to a
+// buffer in between, and a connection's batches stay ahead of the
+// requests it queues later
+void HttpSink::flush(unique_lock<mutex> &guard, bool wait)
+{
+  string values;
+
+  for (int vid=0; vid<NUM_OF_VECTORS; vid++)
+  {
+    for (int training=0; training<2; training++)
+    {
+      if (wait)
+        this->not_full.wait(guard, [this] { return (int)this->queue.size() < this->depth; });
+      if (this->counts[vid][training] == 0)
+        continue;
+      values.swap(this->buffers[vid][training]);
+      this->buffers[vid][training].clear();
+      this->counts[vid][training] = 0;
+      this->enqueue(guard, { "PUT",
+          "/" + this->name + "_vec" + to_string(vid) + (training ? "/training" : "/testing"),
+          "\"{\\\"values\\\": [" + values + "]}\"", false }, false);
+    }
+  }
+}
+
+void HttpSink::put(int vector_id, const float *values, int count, int dim, bool training)
+{
+  string *buf = &this->buffers[vector_id][training];
+  char num[32];
+
+  unique_lock<mutex> guard(this->lock);
+  for (int i=0; i<count; i++)
+  {
+    if (!buf->empty())
+      *buf += ", ";
+    *buf += "[";
+    for (int j=0; j<dim; j++)
+    {
+      if (std::isfinite(values[i * dim + j]))
+        snprintf(num, sizeof(num), "%s%.9g", j ? ", " : "", values[i * dim + j]);
+      else
+        snprintf(num, sizeof(num), "%sNaN", j ? ", " : "");
+      *buf += num;
+    }
+    *buf += "]";
+
+    if (++this->counts[vector_id][training] >= this->batch)
+      this->flush(guard, true);
+  }
+}
+
+// Queued behind the buffered vectors, so the models see all of them first
+void HttpSink::train()
+{
+  unique_lock<mutex> guard(this->lock);
+  this->flush(guard, true);
+  for (int vid=0; vid<NUM_OF_VECTORS; vid++)
+    this->enqueue(guard, { "POST", "/" + this->name + "_vec" + to_string(vid) + "/training", "", false }, true);
+}
+
+void HttpSink::finish()
+{
+  unique_lock<mutex> guard(this->lock);
+  this->flush(guard, true);
+  for (int vid=0; vid<NUM_OF_VECTORS; vid++)
+    this->enqueue(guard, { "GET", "/" + this->name + "_vec" + to_string(vid) + "/result", "", true }, true);
+}
+
+// The sender thread; a partial batch waits at most FLUSH_MS for more
+// vectors
+void HttpSink::send()
+{
+  struct http_request req;
+  string response;
+  int status;
+
+  unique_lock<mutex> guard(this->lock);
+  while (this->running || !this->queue.empty())
+  {
+    if (this->queue.empty())
+    {
+      if (!this->not_empty.wait_for(guard, chrono::milliseconds(FLUSH_MS),
+            [this] { return !this->queue.empty() || !this->running; }))
+        this->flush(guard, false);
+      continue;
+    }
+
+    req = move(this->queue.front());
+    this->queue.pop_front();
+    this->not_full.notify_all();
+
+    guard.unlock();
+    response.clear();
+    status = this->request(req.method, req.path, req.body, &response);
+    if (status != 200 || response.find("\"failure\"") != string::npos)
+      LOG_WARN("[!] %s %s failed (status %d): %s\n", req.method, req.path.c_str(), status, response.c_str());
+    else if (req.log)
+      LOG_INFO("[Result - %s] %s\n", req.path.c_str(), response.c_str());
+    guard.lock();
+  }
+}
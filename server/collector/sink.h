@@ -0,0 +1,114 @@
+#ifndef __SINK_H__
+#define __SINK_H__
+
+#include <cstdio>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "../../edge/vector_layout.h"
+
+// Where the collector hands the decoded vectors (the AI module in
+// server.py). One sink is shared by all event loops, so every method may
+// be called from several threads at once
+class Sink
+{
+  public:
+    virtual ~Sink() {}
+
+    virtual int init() { return 0; }
+    // 'count' vectors of 'dim' floats, native byte order
+    virtual void put(int vector_id, const float *values, int count, int dim, bool training) = 0;
+    // A connection finished its training vectors
+    virtual void train() {}
+    // A connection finished all of its vectors
+    virtual void finish() {}
+};
+
+// Drops everything; measures the collector alone
+class NullSink : public Sink
+{
+  public:
+    void put(int vector_id, const float *values, int count, int dim, bool training) override;
+};
+
+// Appends one CSV line per vector: vector_id,training,value...
+class FileSink : public Sink
+{
+  private:
+    std::string path;
+    FILE *fp;
+    std::mutex lock;
+
+  public:
+    FileSink(const char *path);
+    ~FileSink();
+
+    int init() override;
+    void put(int vector_id, const float *values, int count, int dim, bool training) override;
+};
+
+// Talks to the AI module like server.py: creates one model per vector id
+// ("<name>_vec<id>"), PUTs the vectors to /training or /testing, POSTs
+// /training when a connection is done training and logs /result at the
+// end. As server.py's Bridge, the vectors are buffered per model and sent
+// in batches ({"values": [...]}) by one sender thread over a keep-alive
+// connection, so the event loops only wait when the queue is full; a
+// partial batch waits at most FLUSH_MS for more vectors. A frame is
+// acknowledged once its vectors are buffered: the buffers and the queue
+// live in memory, and acknowledged vectors that the sender has not
+// delivered yet are lost if the collector dies
+struct http_request
+{
+  const char *method;
+  std::string path;
+  std::string body;
+  bool log;                   // log the response (/result)
+};
+
+class HttpSink : public Sink
+{
+  private:
+    std::string name;
+    std::string algorithm;
+    std::string addr;
+    int port;
+    int sock;
+    int batch;
+    int depth;
+
+    // buffered vectors per vector id, testing [0] and training [1]: the
+    // JSON instances joined by ", "
+    std::string buffers[NUM_OF_VECTORS][2];
+    int counts[NUM_OF_VECTORS][2];
+
+    std::mutex lock;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<struct http_request> queue;
+    std::thread sender;
+    bool running;
+
+    int connect();
+    int request(const char *method, const std::string &path, const std::string &body,
+        std::string *response);
+    void enqueue(std::unique_lock<std::mutex> &guard, struct http_request req, bool wait);
+    void flush(std::unique_lock<std::mutex> &guard, bool wait);
+    void send();
+
+  public:
+    HttpSink(const char *name, const char *algorithm, const char *addr, int port);
+    ~HttpSink();
+
+    // Vectors per PUT (default 64) and pending requests before put()
+    // waits (default 1024)
+    void setBatch(int batch, int depth);
+
+    int init() override;
+    void put(int vector_id, const float *values, int count, int dim, bool training) override;
+    void train() override;
+    void finish() override;
+};
+
+#endif /* __SINK_H__ */
@@ -4,25 +4,110 @@ import threading
 import argparse
 import logging
 import json
+import os
 import sys
 import struct
+import queue
+import time
 
 # Operation codes used for communication protocol
 OPCODE_DATA = 1
 OPCODE_WAIT = 2
 OPCODE_DONE = 3
 OPCODE_QUIT = 4
+OPCODE_BATCH = 5  # [opcode, vector_id, count (2 bytes)] + count vectors
+
+# Each vector ID maps to a model with a specific input dimension and index.
+# The table is generated from edge/vector_layout.h ("make vector_info" in edge/)
+VECTOR_INFO_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "vector_info.json")
+with open(VECTOR_INFO_FILE) as f:
+    VECTOR_INFO = {int(vid): info for vid, info in json.load(f).items()}
+
+
+class Bridge:
+    """
+    Buffers the vectors per model and endpoint and sends them to the AI
+    module in batches ({"values": [...]}) from one sender thread, so a
+    handler only waits for the AI module when the bounded queue is full.
+    Requests are enqueued under the lock and sent in order by the one
+    thread: the data of a model always reaches the AI module before the
+    /training POST that follows it.
+
+    A frame is acknowledged to the edge once its vectors are buffered; a
+    partial batch waits at most `interval` seconds for more vectors. The
+    buffers and the queue live in memory: the acknowledged vectors that
+    the sender has not delivered yet are lost if the server dies.
+    """
+
+    def __init__(self, caddr, cport, batch, depth, interval):
+        self.base = f"http://{caddr}:{cport}"
+        self.batch = batch
+        self.interval = interval
+        self.buffers = {}  # (model name, endpoint) -> [vector, ...]
+        self.lock = threading.Lock()
+        self.queue = queue.Queue(maxsize=depth)
+        self.session = requests.Session()
+
+        threading.Thread(target=self.sender, daemon=True).start()
+        if interval > 0:
+            threading.Thread(target=self.flusher, daemon=True).start()
+
+    def put(self, model_name, endpoint, values):
+        # Queues one vector; returns once it is buffered or enqueued
+        with self.lock:
+            buf = self.buffers.setdefault((model_name, endpoint), [])
+            buf.append(values)
+            if len(buf) >= self.batch:
+                self._enqueue_batch(model_name, endpoint)
+
+    def post(self, path):
+        # Queues a POST behind everything buffered so far
+        with self.lock:
+            for model_name, endpoint in list(self.buffers):
+                self._enqueue_batch(model_name, endpoint)
+            self.queue.put(("POST", path, None))
+
+    def flush(self):
+        with self.lock:
+            for model_name, endpoint in list(self.buffers):
+                self._enqueue_batch(model_name, endpoint)
+
+    def drain(self):
+        # Waits until the AI module has everything queued so far
+        self.flush()
+        self.queue.join()
+
+    def _enqueue_batch(self, model_name, endpoint):
+        values = self.buffers.pop((model_name, endpoint))
+        payload = json.dumps({"values": values})
+        self.queue.put(("PUT", f"/{model_name}/{endpoint}", payload))
+
+    def flusher(self):
+        # Bounds how long a partial batch waits for more vectors
+        while True:
+            time.sleep(self.interval)
+            self.flush()
 
-# Each vector ID maps to a model with a specific input dimension and index
-VECTOR_INFO = {
-    0: {"dim": 2, "index": 1},  # vec0: [discomfort_index, avg_power]
-    1: {"dim": 3, "index": 2},  # vec1: [max_temp, avg_humid, avg_power]
-    2: {"dim": 5, "index": 4},  # vec2: [max_humid, max_temp, month, year, avg_power]
-}
+    def sender(self):
+        while True:
+            method, path, payload = self.queue.get()
+            try:
+                if method == "PUT":
+                    result = self.session.put(self.base + path, json=payload).json()
+                    if result.get("opcode") == "failure":
+                        logging.error(
+                            f"Failed to send data to AI module: {result.get('reason', 'unknown')}"
+                        )
+                else:
+                    self.session.post(self.base + path)
+            except Exception as e:
+                logging.warning(f"[!] {method} {path} failed: {e}")
+            finally:
+                self.queue.task_done()
 
 
 class Server:
-    def __init__(self, name, algorithm, port, caddr, cport, ntrain, ntest):
+    def __init__(self, name, algorithm, port, caddr, cport, ntrain, ntest, batch, depth, interval):
         self.name = name
         self.algorithm = algorithm
         self.port = port
@@ -33,6 +118,7 @@ class Server:
 
         # Initialize AI models on the external AI module
         self._init_models()
+        self.bridge = Bridge(caddr, cport, batch, depth, interval)
 
         # Setup TCP socket server
         self.socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
@@ -77,96 +163,98 @@ class Server:
             # Start a new thread to handle communication with this client
             threading.Thread(target=self.handler, args=(client,)).start()
 
-    def parse_and_send(self, vector_id, buf, is_training):
+    def parse_and_send(self, vector_id, values, is_training):
         """
-        Parse binary data buffer into float values and send it to the AI module
-        via HTTP PUT request. Used for both training and testing.
+        Queue one decoded vector for the AI module's training or testing
+        endpoint; the bridge sends it with the rest of its batch.
         """
-        # Validate the vector ID
-        if vector_id not in VECTOR_INFO:
-            logging.error("Invalid vector ID: {}".format(vector_id))
-            return
-
-        dim = VECTOR_INFO[vector_id]["dim"]
-
-        # Validate payload size (must be dim * 4 bytes since each float is 4 bytes)
-        if len(buf) != dim * 4:
-            logging.error(
-                f"Payload length mismatch for vec{vector_id}: expected {dim*4}, got {len(buf)}"
-            )
-            return
-
-        # Unpack the binary buffer into float values (big-endian format)
-        fmt = f">{dim}f"
-        values = list(struct.unpack(fmt, buf))
-        logging.info(f"[vec{vector_id}] Received values: {values}")
-
-        # Build the model name and target endpoint
+        logging.debug(f"[vec{vector_id}] Received values: {values}")
+
         model_name = f"{self.name}_vec{vector_id}"
         endpoint = "training" if is_training else "testing"
-        url = f"http://{self.caddr}:{self.cport}/{model_name}/{endpoint}"
+        self.bridge.put(model_name, endpoint, values)
 
-        # Send the data to the AI module for training or testing
-        response = requests.put(url, json=json.dumps({"value": values}))
-        result = response.json()
-
-        # Log error if AI module reports failure
-        if result.get("opcode") == "failure":
-            logging.error(
-                f"Failed to send data to AI module: {result.get('reason', 'unknown')}"
-            )
+    def recv_exact(self, client, n):
+        """
+        Reads exactly n bytes (fewer only if the connection is closed).
+        """
+        buf = b""
+        while len(buf) < n:
+            chunk = client.recv(n - len(buf))
+            if not chunk:
+                break
+            buf += chunk
+        return buf
+
+    def train_models(self):
+        # After training data is sent, notify the AI module to train the model
+        for vid in VECTOR_INFO:
+            self.bridge.post(f"/{self.name}_vec{vid}/training")
 
     def handler(self, client):
         """
         Handles communication with a single client.
         It processes both training and testing data, sends them to the AI module,
         and retrieves the final results.
+        A frame is either one vector (OPCODE_DATA) or a batch of vectors
+        (OPCODE_BATCH); every frame is answered with a single opcode.
         """
-        for is_training, count in [(True, self.ntrain), (False, self.ntest)]:
-            for _ in range(count):
-                # Read 2-byte header: [opcode (1 byte), vector_id (1 byte)]
-                header = client.recv(2)
-                if len(header) < 2:
-                    logging.error("Incomplete header")
-                    return
-                opcode, vector_id = header[0], header[1]
-
-                # Only OPCODE_DATA is accepted at this point
-                if opcode != OPCODE_DATA:
-                    logging.error("Invalid opcode: {}".format(opcode))
-                    return
-
-                # Get the expected payload dimension for this vector ID
-                dim = VECTOR_INFO.get(vector_id, {}).get("dim", 0)
-                if dim == 0:
-                    logging.error(f"Unknown vector ID: {vector_id}")
-                    return
-
-                # Read the payload containing float values (dim * 4 bytes)
-                payload = client.recv(dim * 4)
-                if len(payload) != dim * 4:
-                    logging.error("Incomplete payload")
-                    return
-
-                # Parse and send the payload to the AI module
-                self.parse_and_send(vector_id, payload, is_training)
-
-                # Notify the client that this data point is processed
+        total = self.ntrain + self.ntest
+        received = 0
+        if self.ntrain == 0:
+            self.train_models()
+        while received < total:
+            # Read 2-byte header: [opcode (1 byte), vector_id (1 byte)]
+            header = self.recv_exact(client, 2)
+            if len(header) < 2:
+                logging.error("Incomplete header")
+                return
+            opcode, vector_id = header[0], header[1]
+
+            # A batch carries its number of vectors in the next 2 bytes
+            if opcode == OPCODE_DATA:
+                count = 1
+            elif opcode == OPCODE_BATCH:
+                count = struct.unpack(">H", self.recv_exact(client, 2))[0]
+            else:
+                logging.error("Invalid opcode: {}".format(opcode))
+                return
+
+            # Get the expected payload dimension for this vector ID
+            dim = VECTOR_INFO.get(vector_id, {}).get("dim", 0)
+            if dim == 0:
+                logging.error(f"Unknown vector ID: {vector_id}")
+                return
+
+            # Read the payload containing float values (count * dim * 4 bytes)
+            payload = self.recv_exact(client, count * dim * 4)
+            if len(payload) != count * dim * 4:
+                logging.error("Incomplete payload")
+                return
+
+            # Decode the frame at once (big-endian floats) and queue each
+            # vector for the AI module; a batch may straddle the end of
+            # the training data
+            floats = struct.unpack(f">{count * dim}f", payload)
+            for k in range(count):
+                if received == total:
+                    break
+                vector = list(floats[k * dim : (k + 1) * dim])
+                self.parse_and_send(vector_id, vector, received < self.ntrain)
+                received += 1
+                if received == self.ntrain:
+                    self.train_models()
+
+            # Notify the client that this frame is processed (buffered)
+            if received < total:
                 client.send(OPCODE_DONE.to_bytes(1, "big"))
 
-            if is_training:
-                # After training data is sent, notify the AI module to train the model
-                for vid in VECTOR_INFO:
-                    url = f"http://{self.caddr}:{self.cport}/{self.name}_vec{vid}/training"
-                    try:
-                        requests.post(url)
-                    except:
-                        logging.warning(f"Training failed for vec{vid}")
-
         # Notify the client that all data is processed
         client.send(OPCODE_QUIT.to_bytes(1, "big"))
 
-        # Retrieve final testing results from AI module for all vector types
+        # Retrieve final testing results from AI module for all vector types,
+        # once it has every queued vector
+        self.bridge.drain()
         for vid in VECTOR_INFO:
             model_name = f"{self.name}_vec{vid}"
             url = f"http://{self.caddr}:{self.cport}/{model_name}/result"
@@ -194,6 +282,11 @@ def parse_args():
     parser.add_argument("--cport", type=int, required=True)
     parser.add_argument("--ntrain", type=int, default=10)
     parser.add_argument("--ntest", type=int, default=10)
+    # Vectors per PUT to the AI module, pending PUTs before the handlers
+    # wait, and how long a partial batch may wait (seconds)
+    parser.add_argument("--batch", type=int, default=64)
+    parser.add_argument("--queue", type=int, default=1024)
+    parser.add_argument("--flush-interval", type=float, default=0.5)
     return parser.parse_args()
 
 
@@ -210,6 +303,9 @@ def main():
         args.cport,
         args.ntrain,
         args.ntest,
+        args.batch,
+        args.queue,
+        args.flush_interval,
     )
 
 
@@ -0,0 +1,226 @@
+#include "../edge/setting.h"
+#include "../edge/edge.h"
+#include "../edge/opcode.h"
+#include "../edge/vector_layout.h"
+#include "../edge/byte_codec.h"
+#include "../edge/logger.h"
+#include "../edge/tools/alloc_track.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// Fails when the steady-state heap allocations per record of Edge::run
+// exceed the budget, or when records leak. A day costs three allocations
+// today: the DataSet, its HouseData vector and its power column
+#define ALLOC_BUDGET 3.0
+#define LEAK_BUDGET 0.0
+
+#define START_TIME 1609459200
+#define SHORT_RUN 64
+#define LONG_RUN 256
+
+using namespace std;
+
+static bool read_all(int fd, uint8_t *buf, size_t len)
+{
+  size_t off = 0;
+  ssize_t n;
+
+  while (off < len)
+  {
+    n = read(fd, buf + off, len - off);
+    if (n <= 0)
+      return false;
+    off += n;
+  }
+  return true;
+}
+
+// Accepts one connection and answers every frame with OPCODE_DONE until
+// 'records' vectors arrived, then with OPCODE_QUIT; with records = 0 it
+// only drains
+static void serve(int lsock, long records)
+{
+  uint8_t hdr[4], payload[BUFLEN * 16], op;
+  long received = 0;
+  int fd, count, dim;
+
+  fd = accept(lsock, NULL, NULL);
+  if (fd < 0)
+    return;
+
+  while (read_all(fd, hdr, 2))
+  {
+    count = 1;
+    if (hdr[0] == OPCODE_BATCH)
+    {
+      if (!read_all(fd, hdr + 2, 2))
+        break;
+      count = get_be16(hdr + 2);
+    }
+    dim = hdr[1] < NUM_OF_VECTORS ? vector_table[hdr[1]].dim : 0;
+    if (!read_all(fd, payload, (size_t)count * dim * 4))
+      break;
+    received += count;
+
+    if (records > 0)
+    {
+      op = received >= records ? OPCODE_QUIT : OPCODE_DONE;
+      if (write(fd, &op, 1) != 1 || op == OPCODE_QUIT)
+        break;
+    }
+  }
+  close(fd);
+}
+
+static int listen_loopback()
+{
+  struct sockaddr_in addr;
+  int sock;
+
+  sock = socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(sock, 1) < 0)
+  {
+    perror("listen");
+    exit(1);
+  }
+  return sock;
+}
+
+static int port_of(int sock)
+{
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+
+  getsockname(sock, (struct sockaddr *)&addr, &len);
+  return ntohs(addr.sin_port);
+}
+
+// Allocations of the calling thread during one Edge::run of 'records' days
+static struct alloc_stats run_edge(long records, int batch, bool hourly)
+{
+  struct alloc_stats ret = {};
+  int lsock;
+  Edge *edge;
+
+  lsock = listen_loopback();
+  thread server(serve, lsock, records);
+
+  edge = new Edge("127.0.0.1", port_of(lsock));
+  edge->setSeed(1);
+  edge->setHourly(hourly);
+  edge->setBatchSize(batch);
+  edge->init();
+  edge->setVectorID(2);
+  {
+    AllocScope scope(&ret);
+    edge->run();
+  }
+  delete edge;
+
+  server.join();
+  close(lsock);
+  return ret;
+}
+
+// Steady-state allocations per record: the difference of a long and a
+// short run cancels the one-off setup costs
+static bool check_run(int batch, bool hourly)
+{
+  struct alloc_stats s, l;
+  double allocs, bytes, live;
+  bool ok;
+
+  s = run_edge(SHORT_RUN, batch, hourly);
+  l = run_edge(LONG_RUN, batch, hourly);
+  allocs = (double)(l.count - s.count) / (LONG_RUN - SHORT_RUN);
+  bytes = (double)(l.bytes - s.bytes) / (LONG_RUN - SHORT_RUN);
+  live = ((double)(l.count - l.frees) - (double)(s.count - s.frees)) / (LONG_RUN - SHORT_RUN);
+  ok = allocs <= ALLOC_BUDGET && live <= LEAK_BUDGET;
+
+  printf("Edge::run batch=%-2d %-6s allocs/record: %5.2f  bytes/record: %8.1f  leaked/record: %5.2f  %s\n",
+      batch, hourly ? "hourly" : "daily", allocs, bytes, live, ok ? "ok" : "OVER BUDGET");
+  return ok;
+}
+
+// The same data path as Edge::run, one component at a time
+static void report_components(bool hourly)
+{
+  struct alloc_stats generate = {}, history = {}, process = {}, send = {}, release = {};
+  DataReceiver *dr;
+  HistoryStore *hs;
+  ProcessManager *pm;
+  NetworkManager *nm;
+  DataSet *ds;
+  uint8_t buf[BUFLEN];
+  int lsock, dlen;
+
+  lsock = listen_loopback();
+  thread server(serve, lsock, 0);
+
+  dr = new DataReceiver();
+  dr->setSeed(1);
+  dr->setHourly(hourly);
+  dr->init();
+  hs = new HistoryStore(HISTORY_DAYS, NUM_OF_CUSTOMER);
+  hs->init();
+  pm = new ProcessManager();
+  pm->setVectorID(2);
+  nm = new NetworkManager("127.0.0.1", port_of(lsock));
+  nm->init();
+
+  for (int i=0; i<LONG_RUN; i++)
+  {
+    { AllocScope scope(&generate); ds = dr->getDataSet(START_TIME + (time_t)i * 86400); }
+    { AllocScope scope(&history); hs->append(ds); }
+    { AllocScope scope(&process); dlen = pm->processData(ds, buf); }
+    { AllocScope scope(&send); nm->sendData(buf, dlen, 2); }
+    { AllocScope scope(&release); delete ds; }
+  }
+
+  printf("Components (%s, per record):\n", hourly ? "hourly" : "daily");
+  printf("  getDataSet   allocs: %5.2f  bytes: %8.1f\n", (double)generate.count / LONG_RUN, (double)generate.bytes / LONG_RUN);
+  printf("  append       allocs: %5.2f  bytes: %8.1f\n", (double)history.count / LONG_RUN, (double)history.bytes / LONG_RUN);
+  printf("  processData  allocs: %5.2f  bytes: %8.1f\n", (double)process.count / LONG_RUN, (double)process.bytes / LONG_RUN);
+  printf("  sendData     allocs: %5.2f  bytes: %8.1f\n", (double)send.count / LONG_RUN, (double)send.bytes / LONG_RUN);
+  printf("  delete       frees:  %5.2f\n", (double)release.frees / LONG_RUN);
+
+  delete nm;
+  server.join();
+  close(lsock);
+  delete pm;
+  delete hs;
+  delete dr;
+}
+
+int main(int argc, char *argv[])
+{
+  bool ok = true;
+
+  if (!alloc_tracking())
+  {
+    printf("[*] Allocation tracking is compiled out (sanitizer build); skipped\n");
+    return 0;
+  }
+
+  log_set_level(LOG_LEVEL_WARN);
+
+  report_components(false);
+  report_components(true);
+
+  ok &= check_run(1, false);
+  ok &= check_run(1, true);
+  ok &= check_run(16, false);
+
+  printf(ok ? "[*] Allocation budget: PASS\n" : "[!] Allocation budget: FAIL\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#include "../edge/setting.h"
+#include "../edge/data/calendar.h"
+
+#include <cstdio>
+
+// Checks the forms -z accepts and rejects; exits non-zero on a mismatch
+struct offset_case
+{
+  const char *input;
+  int ret;
+  long seconds;
+};
+
+static const struct offset_case cases[] = {
+  { "+09:00", SUCCESS, 32400 },
+  { "-05:30", SUCCESS, -19800 },
+  { "+9", SUCCESS, 32400 },
+  { "-1", SUCCESS, -3600 },
+  { "+14", SUCCESS, 50400 },
+  { "+00:00", SUCCESS, 0 },
+  { "3600", SUCCESS, 3600 },
+  { "0", SUCCESS, 0 },
+  { "+-1:00", FAILURE, 0 },
+  { "-+1", FAILURE, 0 },
+  { "+ 1", FAILURE, 0 },
+  { "+1:-5", FAILURE, 0 },
+  { "+1:5", FAILURE, 0 },
+  { "+01:60", FAILURE, 0 },
+  { "+15", FAILURE, 0 },
+  { "+14:30", FAILURE, 0 },
+  { "+123", FAILURE, 0 },
+  { "+", FAILURE, 0 },
+  { "", FAILURE, 0 },
+  { " 3600", FAILURE, 0 },
+  { "3600s", FAILURE, 0 },
+  { "99999", FAILURE, 0 },
+};
+
+int main()
+{
+  long seconds;
+  int ret, failed = 0;
+
+  for (const struct offset_case &c : cases)
+  {
+    seconds = 0;
+    ret = parseUtcOffset(c.input, &seconds);
+    if (ret != c.ret || (ret == SUCCESS && seconds != c.seconds))
+    {
+      printf("  >> \"%s\": %s %ld, expected %s %ld\n", c.input,
+          ret == SUCCESS ? "accepted" : "rejected", seconds,
+          c.ret == SUCCESS ? "accepted" : "rejected", c.seconds);
+      failed++;
+    }
+  }
+
+  printf("[*] UTC offsets: %d of %d cases %s\n", (int)(sizeof(cases) / sizeof(cases[0])) - failed,
+      (int)(sizeof(cases) / sizeof(cases[0])), failed ? "FAIL" : "PASS");
+  return failed ? 1 : 0;
+}